@@ -18,17 +18,25 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Analysis/RegionPass.h"
 #include "llvm/Analysis/RegionInfo.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/DependenceAnalysis.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/IVDescriptors.h"
 #include "llvm/Analysis/RegionIterator.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/RegionIterator.h"
@@ -36,51 +44,116 @@
 #include "llvm/Analysis/BlockFrequencyInfoImpl.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/ProfileData/InstrProf.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Instrumentation.h"
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include "llvm/IR/CFG.h"
 //#include "../Identify.h" // Header file for all 3 passes. (AccelSeeker, IdentifyBbs, IdentifyFunctions)
-#include "AccelSeeker.h"
 
 #define DEBUG_TYPE "AccelSeeker"
 
 #define HW_COST_AVG
 //#define TASKS_LIST 
 //#define LOOP_LEVEL_PARALLELISM 
+#define LOG_LEVEL_FILES // Also write SW_i/HW_i/AREA_i. Output only, the pass keeps them in memory.
+//#define PARALLEL_COST_ESTIMATION // Estimate the BB Costs of all Functions on a thread pool.
+//#define LOOP_PIPELINING // Single-BB innermost Loops are modulo scheduled (HW_COST_AVG).
+//#define CLOCK_SWEEP // HW Latency of every candidate at every clock of clocks.txt (CLOCK_i).
+//#define CALL_SITE_FREQ // Callee Costs scaled by the exact count of each call site.
 
 #ifdef  LOOP_LEVEL_PARALLELISM 
- #define MAX_LUF 8
+ #define MAX_LUF 8 // Every Unroll Factor from 1 up to MAX_LUF is estimated.
 #endif
 
+#include "AccelSeeker.h" // After the toggles above - the header reads them as well.
+
 STATISTIC(RegionCounter, "The # of Regions Identified");
 
 using namespace llvm;
 
 namespace {
 
-  struct AccelSeeker : public FunctionPass {
+  struct AccelSeeker : public ModulePass {
     static char ID; // Pass Identification, replacement for typeid
 
-    std::vector<Function *> Function_list; // Global Function List
+    FunctionRegistry Function_list; // Global Function List
     std::vector<long int> Function_HW_Cost_list; // Global Function List HW Latency (Cycles)
     std::vector<long int> Function_SW_Cost_list; // Global Function List SW Latency (Cycles)
     std::vector<long int> Function_HW_Area_list; // Global Function List HW Area Estimation (LUTs)
-    std::vector<Function *> Function_Area_list; //  Global Function List for Area Estimation
+    SmallPtrSet<Function *, 16> Function_Area_list; //  Callees already counted in the Area of a Super Function
     std::vector<Function *> Function_missing_list; //  Global Function List for Area Estimation
-    std::vector<StringRef> Function_Names_list; // Global Function List Names
 
+    BlockFrequencyInfo *BFI; // Analyses of the Function currently estimated.
+    LoopInfo *LI;
+    Function *AnalyzedFunction;
+
+#ifdef LOOP_LEVEL_PARALLELISM
+    // Trip Count and loop carried dependences of a Loop, keyed by its header
+    // (Loops are rebuilt every time the Function analyses run again).
+    struct LoopSummary {
+      unsigned int TripCount; // 0 when not known at compile time.
+      bool Carried;
+    };
+
+    DenseMap<BasicBlock *, LoopSummary> Loop_Summary;
+    SmallPtrSet<Function *, 16> Summarized_Functions;
+#endif
+
+    // Cost of a Super Function as logged at a Level, or carried over from the
+    // Level below when nothing was logged - i.e. what the lookup in the
+    // SW_i/HW_i/AREA_i files of Levels <= i would find.
+    struct LoggedCost {
+      bool Logged;
+      unsigned long long int Cost;
+      int EntryCount;
+    };
+
+    enum CostKind { SW_COST = 0, HW_COST, AREA_COST, NUM_COSTS };
+
+    struct FunctionSummary {
+      std::vector<LoggedCost> Costs[NUM_COSTS]; // Indexed by Level.
+      std::vector<AreaVector> Resources;        // Indexed by Level, kept as Costs[AREA_COST].
+#ifdef CLOCK_SWEEP
+      std::vector<std::vector<LoggedCost> > Clock_Costs; // HW Cost indexed by Clock, then Level.
+#endif
+    };
+
+    DenseMap<Function *, FunctionSummary> Summary_Table; // Filled as Functions are finished.
+
+    DenseMap<BasicBlock *, BBCost> BBCost_Cache; // Costs of each BB, computed once per run.
+    ChainedStartMap Chained_Start_Cache;          // Chained starts of the BBs (OPERATION_CHAINING).
+
+#ifdef LOOP_PIPELINING
+    DenseMap<BasicBlock *, ModuloSchedule> Schedule_Cache; // Modulo Schedules of Loop bodies.
+#endif
+
+#ifdef CLOCK_SWEEP
+    std::vector<float> Clocks; // nSecs per Cycle of every clock swept.
+    DenseMap<BasicBlock *, std::vector<double> > Clock_Cycles_Cache; // HW Cycles of each BB per Clock.
+    std::vector<ChainedStartMap> Clock_Chained_Start_Cache;           // Chained starts of the BBs per Clock.
+#endif
 
 
-    AccelSeeker() : FunctionPass(ID) {}
+    AccelSeeker() : ModulePass(ID) {}
 
     // Run on the whole app.
-   bool runOnFunction(Function &F){
+    //
+    // The call graph is traversed bottom-up once. Every SCC is finished for
+    // all Levels (0 up to the Level in level.txt) before its callers, so the
+    // Summary_Table entries of the callees are already complete when read.
+    //
+   bool runOnModule(Module &M){
    std::ifstream level_file;
    int level;
 
@@ -93,11 +166,11 @@ namespace {
     while(!level_file.eof()) {
       level_file >> level; // read first column number
 		}
- 
+
 #ifdef TASKS_LIST
    std::ifstream tasks_file; // File containing the Top Performing Tasks from AccelSeeker.
    std::string task_name;
-   std::string Function_Name = GetValueName(&F);
+   std::vector<std::string> Tasks_list;
 
     tasks_file.open("tasks_extracted.txt");
       if(tasks_file.fail()) { // checks to see if file opended 
@@ -106,65 +179,341 @@ namespace {
       }
       while(!tasks_file.eof()) {
                  tasks_file >> task_name; // read first column number
-         if (Function_Name == task_name) {
+                 Tasks_list.push_back(task_name);
+      }
+#endif
 
-            errs() << "\n\n Function Name : " << F.getName() << "\n";
-            errs() << "\n\n Initialize list with Funs : " << "\n";
-            initFunctionList(&F);
+      // Optional - costs of the Target per opcode and its clock (see loadTargetDescription).
+      if (std::ifstream("target.txt").good() && !loadTargetDescription("target.txt")) {
+        errs() << "error_target_file" << "\n";
+        return 1;
+      }
 
-            for (int i=0; i< Function_list.size(); i++)
-              errs() << GetValueName(Function_list[i]) << "\n";
+      // Optional - counts of an indexed profile in place of the ones of the IR.
+      if (!applyProfile(M)) {
+        errs() << "error_profile_file" << "\n";
+        return 1;
+      }
 
-            runOnFunctionLoop(&F, level); // Analysis Taking Place.
-         }
-       } //End of while
-#else
-       std::string Function_Name = GetValueName(&F); 	// To avoid the break of the analysis because of 
-       std::string forbidden_string = "_ZNS"; 		//  bad system calls.
-       std::string forbidden_string2 = "_ZN9"; 		
-       std::string forbidden_string3 = "_ZSt8"; 		
-       std::string forbidden_string4 = "_ZN1"; 		
-       std::string forbidden_string5 = "llvm"; 		
-       std::string forbidden_string6 = "_ZN8DFGDepth"; 		
-       std::string forbidden_string7 = "_ZNKSt"; 		
-       std::string forbidden_string8 = "_ZSt"; 		
-       std::string forbidden_string9 = "_ZNK9"; 		
-       std::string forbidden_string10 = "_ZNK8"; 		
-       std::string forbidden_string11 = "_ZNK1"; 		
-       std::string forbidden_string12 = "hpvm"; 		
-       std::string forbidden_string13 = "_ZL"; 		
-       std::string forbidden_string14 = "_Z15"; 		
-       std::string forbidden_string15 = "_Z12"; 		
-
-       if (!isSystemCall(&F)){ 	// Uncomment to use the old Analysis Pass that iterates over all functions. 
-//	  if (Function_Name.find(forbidden_string) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string2) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string3) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string4) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string5) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string6) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string7) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string8) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string9) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string10) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string11) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string12) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string13) == std::string::npos && 
-//	  	Function_Name.find(forbidden_string14) == std::string::npos && 
-//		Function_Name.find(forbidden_string15) == std::string::npos ) { // Checks whether forbidden string is subset of Candidate's name.
-	     errs() << "\n\n Function Name : " << F.getName() << "\n";
-             errs() << "\n\n Initialize list with Funs : " << "\n";
-             initFunctionList(&F);
-            
-             for (int i=0; i< Function_list.size(); i++)
-               errs() << GetValueName(Function_list[i]) << "\n";
-            
-             runOnFunctionLoop(&F, level); // Analysis Taking Place.
-//	  }
-	}
+      // Targets of the indirect calls, looked up by the values of their value profiles.
+      indexProfiledFunctions(M);
+
+#ifdef MEMORY_PORT_MODEL
+      // Optional - Ports of some arrays, one "<Function> <Array> <Ports>" per line.
+      std::ifstream mem_ports_file("mem_ports.txt");
+      std::string mem_function, mem_array;
+      unsigned mem_ports;
+
+      while (mem_ports_file >> mem_function >> mem_array >> mem_ports)
+        Memory_Ports_Table[mem_function + " " + mem_array] = mem_ports;
+#endif
+
+#ifdef CLOCK_SWEEP
+      // Clocks to sweep, in nSecs per Cycle (e.g. "10 5 4 3.33"). The Target clock if none.
+      std::ifstream clocks_file("clocks.txt");
+      float clock;
+
+      while (clocks_file >> clock)
+        if (clock > 0)
+          Clocks.push_back(clock);
+      if (Clocks.empty())
+        Clocks.push_back(Target.NSecsPerCycle);
+      Clock_Chained_Start_Cache.resize(Clocks.size());
+#endif
+
+      // Start all the Level files afresh - they are appended to while traversing.
+      for (int i = 0; i <= level; i++) {
+        myfile.open ("LA_" + std::to_string(i) + ".txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+        myfile.open ("RES_" + std::to_string(i) + ".txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+#ifdef LOG_LEVEL_FILES
+        myfile.open ("SW_" + std::to_string(i) + ".txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+        myfile.open ("HW_" + std::to_string(i) + ".txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+        myfile.open ("AREA_" + std::to_string(i) + ".txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+#endif
+#ifdef LOOP_LEVEL_PARALLELISM
+        myfile.open ("LLP_" + std::to_string(i) + ".txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+#endif
+#ifdef CLOCK_SWEEP
+        myfile.open ("CLOCK_" + std::to_string(i) + ".txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+#endif
+      }
+#ifdef LOOP_LEVEL_PARALLELISM
+      myfile.open ("LLP_LOOPS.txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+#endif
+#ifdef LOOP_PIPELINING
+      myfile.open ("PIPELINE.txt", std::ofstream::out | std::ofstream::trunc); myfile.close();
+#endif
+
+      std::vector<std::vector<Function *> > SCCs;
+      getCallGraphSCCs(M, SCCs);
+      AnalyzedFunction = nullptr;
+
+#ifdef TASKS_LIST
+      // Only the Functions of the Tasks list are analyzed.
+      for (unsigned int scc = 0; scc < SCCs.size(); scc++)
+        SCCs[scc].erase(std::remove_if(SCCs[scc].begin(), SCCs[scc].end(), [&Tasks_list](Function *F) {
+            return std::find(Tasks_list.begin(), Tasks_list.end(), GetValueName(F)) == Tasks_list.end();
+          }), SCCs[scc].end());
+#endif
+
+#ifdef PARALLEL_COST_ESTIMATION
+      estimateBBCostsInParallel(SCCs);
+#endif
+
+      for (unsigned int scc = 0; scc < SCCs.size(); scc++) {
+
+        std::vector<Function *> &Candidates_list = SCCs[scc]; // Functions of the SCC to be analyzed.
+
+        for (unsigned int i = 0; i < Candidates_list.size(); i++) {
+          Function *F = Candidates_list[i];
+
+          errs() << "\n\n Function Name : " << F->getName() << "\n";
+          getFunctionAnalyses(F);
+          initFunctionList(F);
+        }
+
+        // Functions of the same SCC call each other, so Level i of all of
+        // them is needed before Level i+1 of any.
+        for (int CurrentLevel = 0; CurrentLevel <= level; CurrentLevel++)
+          for (unsigned int i = 0; i < Candidates_list.size(); i++) {
+            getFunctionAnalyses(Candidates_list[i]);
+            runOnFunctionLoop(Candidates_list[i], CurrentLevel); // Analysis Taking Place.
+          }
+      }
+
+      return !ProfileFile.empty(); // Only the profile metadata is changed.
+    }
+
+
+    // Get the Analyses (Block Frequencies, Loops) of the Function to be estimated.
+    //
+    void getFunctionAnalyses(Function *F) {
+
+      if (F == AnalyzedFunction)
+        return;
+
+      BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>(*F).getBFI();
+      LI  = &getAnalysis<LoopInfoWrapperPass>(*F).getLoopInfo();
+      AnalyzedFunction = F;
+
+#ifdef LOOP_LEVEL_PARALLELISM
+      if (Summarized_Functions.insert(F).second)
+        summarizeLoops(F);
+#endif
+    }
+
+#ifdef LOOP_LEVEL_PARALLELISM
+    // Find the Trip Count and the loop carried dependences of every Loop of F.
+    //
+    // Every getAnalysis on F runs all of its Function analyses again (and
+    // frees the previous DependenceInfo and ScalarEvolution), so each one is
+    // used right after it is fetched. BFI and LI stay valid.
+    //
+    void summarizeLoops(Function *F) {
+
+      DependenceInfo *DI = &getAnalysis<DependenceAnalysisWrapperPass>(*F).getDI();
+      for (Loop *L : LI->getLoopsInPreorder())
+        Loop_Summary[L->getHeader()].Carried = hasCarriedMemoryDependence(L, DI);
+
+      ScalarEvolution *SE = &getAnalysis<ScalarEvolutionWrapperPass>(*F).getSE();
+      for (Loop *L : LI->getLoopsInPreorder()) {
+        LoopSummary &Summary = Loop_Summary[L->getHeader()];
+        Summary.TripCount = SE->getSmallConstantTripCount(L);
+        Summary.Carried   = Summary.Carried || hasCarriedPHI(L, SE);
+      }
+
+      // Latency/Area curve of the body of every Loop (its inner Loops apart).
+      myfile.open ("LLP_LOOPS.txt", std::ofstream::out | std::ofstream::app);
+      for (Loop *L : LI->getLoopsInPreorder()) {
+        LoopSummary &Summary = Loop_Summary[L->getHeader()];
+        myfile << GetValueName(F) << "\t" << GetValueName(L->getHeader()) << "\t"
+          << L->getLoopDepth() << "\t" << Summary.TripCount << "\t" << Summary.Carried << "\t";
+
+        for (unsigned int LUF = 1; LUF <= MAX_LUF; LUF++) {
+          unsigned int Factor = getUnrollFactor(Summary.TripCount, Summary.Carried, LUF);
+          long int HWLatency = 0, Area = 0;
+
+          for (Loop::block_iterator BB = L->block_begin(); BB != L->block_end(); ++BB)
+            if (LI->getLoopFor(*BB) == L) {
+              float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+              HWLatency += getBBCost(*BB).HWCycles * (BBFreqFloat / Factor);
+              Area      += getBBCost(*BB).Area * Factor;
+            }
+          myfile << HWLatency << "\t" << Area << "\t";
+        }
+        myfile << "\n";
+      }
+      myfile.close();
+    }
+
+    // Unroll Factor of the innermost Loop of BB (1 outside Loops).
+    //
+    unsigned int getUnrollFactorOfBB(BasicBlock *BB, unsigned int LUF) {
+
+      Loop *L = LI->getLoopFor(BB);
+      if (!L)
+        return 1;
+
+      LoopSummary &Summary = Loop_Summary[L->getHeader()];
+      return getUnrollFactor(Summary.TripCount, Summary.Carried, LUF);
+    }
+#endif
+
+
+    // Get the Costs of a BB, computing them on first use.
+    //
+    BBCost getBBCost(BasicBlock *BB) {
+
+      DenseMap<BasicBlock *, BBCost>::iterator It = BBCost_Cache.find(BB);
+      if (It != BBCost_Cache.end())
+        return It->second;
+
+      BBCost Cost = getCostOfBB(BB, Chained_Start_Cache);
+#ifdef SW_COST_TTI
+      Cost.SWCost = getHostSWCostOfBB(BB, getAnalysis<TargetTransformInfoWrapperPass>().getTTI(*BB->getParent()));
+#endif
+      BBCost_Cache[BB] = Cost;
+      return Cost;
+    }
+
+#ifdef LOOP_PIPELINING
+    // HW Cost of BB when it is the whole body of an innermost Loop, pipelined.
+    // Every entry of the Loop costs (Trip Count - 1) * II + Depth Cycles, the
+    // entries and iterations taken from the Block Frequencies of the preheader
+    // and of BB. Never more than the sequential Cost. Returns false for any
+    // other BB.
+    //
+    bool getPipelinedCostOfBB(BasicBlock *BB, float BBFreqFloat, double &HardwareCostBB) {
+
+      Loop *L = LI->getLoopFor(BB);
+      if (!L || L->getNumBlocks() != 1 || !L->getLoopPreheader())
+        return false;
+
+      float EntryFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(L->getLoopPreheader()).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+      if (EntryFreqFloat <= 0 || BBFreqFloat < EntryFreqFloat)
+        return false;
+
+      DenseMap<BasicBlock *, ModuloSchedule>::iterator It = Schedule_Cache.find(BB);
+      if (It == Schedule_Cache.end()) {
+        It = Schedule_Cache.insert(std::make_pair(BB, getModuloScheduleOfBB(BB))).first;
+
+        myfile.open ("PIPELINE.txt", std::ofstream::out | std::ofstream::app);
+        myfile << GetValueName(BB->getParent()) << "\t" << GetValueName(BB) << "\t"
+          << It->second.RecMII << "\t" << It->second.ResMII << "\t"
+          << It->second.II << "\t" << It->second.Depth << "\n";
+        myfile.close();
+      }
+
+      double Pipelined = (BBFreqFloat - EntryFreqFloat) * It->second.II + EntryFreqFloat * It->second.Depth;
+      HardwareCostBB = std::min(Pipelined, getBBCost(BB).HWCycles * BBFreqFloat);
+      return true;
+    }
 #endif
 
-      return false;
+
+#ifdef PARALLEL_COST_ESTIMATION
+    // Estimate the Costs of the BBs of all Functions concurrently, one task
+    // per Function. Only the IR is read there - BFI and LoopInfo are still
+    // taken serially, as getAnalysis is not thread safe, and so are the
+    // sizes of the allocas, as the DataLayout fills its StructLayouts on
+    // first use. The results are merged into BBCost_Cache in call graph
+    // post-order.
+    //
+    void estimateBBCostsInParallel(std::vector<std::vector<Function *> > &SCCs) {
+
+      std::vector<Function *> Functions;
+      for (unsigned int scc = 0; scc < SCCs.size(); scc++)
+        Functions.insert(Functions.end(), SCCs[scc].begin(), SCCs[scc].end());
+
+      for (unsigned int f = 0; f < Functions.size(); f++)
+        for(Function::iterator BB = Functions[f]->begin(), E = Functions[f]->end(); BB != E; ++BB)
+          for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
+            if (AllocaInst *Alloca = dyn_cast<AllocaInst>(BI))
+              Alloca->getModule()->getDataLayout().getTypeAllocSizeInBits(Alloca->getAllocatedType());
+
+      std::vector<std::vector<BBCost> > Costs(Functions.size());
+      ThreadPool Pool;
+
+      for (unsigned int f = 0; f < Functions.size(); f++)
+        Pool.async([&Functions, &Costs, f]() {
+          ChainedStartMap Chained_Starts; // Chains never leave a Function.
+          for(Function::iterator BB = Functions[f]->begin(), E = Functions[f]->end(); BB != E; ++BB)
+            Costs[f].push_back(getCostOfBB(&*BB, Chained_Starts));
+        });
+      Pool.wait();
+
+      for (unsigned int f = 0; f < Functions.size(); f++) {
+        unsigned int b = 0;
+#ifdef SW_COST_TTI
+        // The TTI of a Function is only valid until the next one is taken - serially.
+        const TargetTransformInfo &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(*Functions[f]);
+#endif
+        for(Function::iterator BB = Functions[f]->begin(), E = Functions[f]->end(); BB != E; ++BB, b++) {
+#ifdef SW_COST_TTI
+          Costs[f][b].SWCost = getHostSWCostOfBB(&*BB, TTI);
+#endif
+          BBCost_Cache[&*BB] = Costs[f][b];
+        }
+      }
+    }
+#endif
+
+
+    // Record the cost of F at CurrentLevel. Levels are recorded in order, and
+    // if nothing was logged at this Level the one of the Level below is kept.
+    //
+    void logSummary(Function *F, CostKind Kind, int CurrentLevel, bool Logged,
+                    unsigned long long int Cost, int EntryCount) {
+
+      logCost(Summary_Table[F].Costs[Kind], CurrentLevel, Logged, Cost, EntryCount);
+    }
+
+    void logCost(std::vector<LoggedCost> &Costs, int CurrentLevel, bool Logged,
+                 unsigned long long int Cost, int EntryCount) {
+
+      LoggedCost Entry = {Logged, Cost, EntryCount};
+
+      if (!Logged && CurrentLevel > 0)
+        Entry = Costs[CurrentLevel-1];
+
+      Costs.resize(CurrentLevel+1);
+      Costs[CurrentLevel] = Entry;
+    }
+
+    // Record the Resources of F at CurrentLevel, as logSummary does for its Area.
+    //
+    void logResources(Function *F, int CurrentLevel, bool Logged, const AreaVector &Resources) {
+
+      std::vector<AreaVector> &Levels = Summary_Table[F].Resources;
+      AreaVector Entry = Resources;
+
+      if (!Logged && CurrentLevel > 0)
+        Entry = Levels[CurrentLevel-1];
+
+      Levels.resize(CurrentLevel+1);
+      Levels[CurrentLevel] = Entry;
+    }
+
+
+    // Get the latest cost of the Callee logged below CurrentLevel.
+    // Returns null if it was never logged (or the Callee is not analyzed).
+    //
+    const LoggedCost *getLoggedCost(Function *Calee, CostKind Kind, int CurrentLevel) {
+
+      DenseMap<Function *, FunctionSummary>::iterator It = Summary_Table.find(Calee);
+      if (It == Summary_Table.end())
+        return nullptr;
+
+      return getLoggedCost(It->second.Costs[Kind], CurrentLevel);
+    }
+
+    const LoggedCost *getLoggedCost(const std::vector<LoggedCost> &Costs, int CurrentLevel) {
+
+      if (CurrentLevel == 0 || (int) Costs.size() < CurrentLevel)
+        return nullptr;
+
+      const LoggedCost &Entry = Costs[CurrentLevel-1];
+      return Entry.Logged ? &Entry : nullptr;
     }
 
 
@@ -172,11 +521,11 @@ namespace {
     //
     bool initFunctionList(Function *F) {
 
-      if (find_function(Function_list, F) == -1 && isSystemCall(F) == false){
+      if (Function_list.find(F) == -1 && isSystemCall(F) == false){
 
         std::string Function_Name = GetValueName(F);
 
-        Function_list.push_back(F);
+        Function_list.insert(F);
        
 	//errs() << " here 1" << "\n";
 
@@ -196,8 +545,6 @@ namespace {
 
         unsigned int AreaFunction = getAreaofFunction(F);
         Function_HW_Area_list.push_back(AreaFunction);
-
-        Function_Names_list.push_back(GetValueName(F));
       }
 
       return true;
@@ -206,10 +553,6 @@ namespace {
 
       virtual bool runOnFunctionLoop(Function *F, int LEVEL) {
 
-  
-        LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
-        ScalarEvolution &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
-
         //std::string Function_Name = F->getName();
         std::string Function_Name = GetValueName(F);
        
@@ -223,8 +566,8 @@ namespace {
                // Function_missing_list_names.clear(); // Function Calls by reference.
 
 #ifdef LOOP_LEVEL_PARALLELISM
-	long int SuperFunctionAreaLUF[8] = {0}, SuperFunctionHWLatencyLUF[8] = {0};
-        for (unsigned int i=0,LUF=1; i<MAX_LUF; i++,LUF*=2) {
+	long int SuperFunctionAreaLUF[MAX_LUF] = {0}, SuperFunctionHWLatencyLUF[MAX_LUF] = {0};
+        for (unsigned int i=0,LUF=1; i<MAX_LUF; i++,LUF++) {
         	 SuperFunctionHWLatencyLUF[i] = logHWCostOfSuperFunctionLUF(F, LEVEL, LUF);
          	Function_Area_list.clear();
          	SuperFunctionAreaLUF[i]              = logAreaofSuperFunctionLUF(F, LEVEL, LUF);
@@ -242,7 +585,8 @@ namespace {
 
        long int SuperFunctionHWLatency = logHWCostOfSuperFunction(F, LEVEL);
        Function_Area_list.clear();
-       long int SuperFunctionArea      = logAreaofSuperFunction(F, LEVEL);
+       AreaVector SuperFunctionResources;
+       long int SuperFunctionArea      = logAreaofSuperFunction(F, LEVEL, SuperFunctionResources);
 
        long int SuperFunctionFreq      = getEntryCount(F);
 
@@ -255,26 +599,45 @@ namespace {
          <<"\n";
        myfile.close();
 
+       // Resources of the Super Function - LUTs as in LA_i, FFs, DSPs, BRAMs.
+#ifdef CLOCK_SWEEP
+       // HW Latency of the Super Function at every clock, in Cycles and in nSecs.
+       myfile.open ("CLOCK_" + std::to_string(LEVEL) + ".txt", std::ofstream::out | std::ofstream::app);
+       myfile << Function_Name;
+       for (unsigned c = 0; c < Clocks.size(); c++) {
+         unsigned long long int Cycles = logHWCostOfSuperFunctionAtClock(F, LEVEL, c);
+         myfile << "\t" << Clocks[c] << "\t" << Cycles << "\t" << (unsigned long long int) round(Cycles * Clocks[c]);
+       }
+       myfile << "\n";
+       myfile.close();
+#endif
+
+       myfile.open ("RES_" + std::to_string(LEVEL) + ".txt", std::ofstream::out | std::ofstream::app);
+       myfile << Function_Name << "\t"
+         << SuperFunctionResources.LUT << "\t"
+         << SuperFunctionResources.FF << "\t"
+         << SuperFunctionResources.DSP << "\t"
+         << SuperFunctionResources.BRAM
+         <<"\n";
+       myfile.close();
+
+       return false;
     }
 
 #ifdef LOOP_LEVEL_PARALLELISM
     long int getHWCostOfFunctionLUF(Function *F, unsigned int LUF) {
 
-      LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
-
       long int HardwareCostFunction=0, HardwareCostBB = 0;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
 
       // Populate worklist with Function's Basic Blocks and their respective BB's Frequencies. Both Per Iteration and Total.
       for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
 
         float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-        HardwareCostBB   = ceil( ( getDelayOfBB(&*BB) ) / NSECS_PER_CYCLE ) * BBFreqFloat ;
+        HardwareCostBB   = getBBCost(&*BB).HWCycles * BBFreqFloat ;
 
-        if (Loop *L = LI.getLoopFor(&*BB) ){
-	    if( BBFreqFloat> 1 )
-        	HardwareCostBB =  ceil( ( getDelayOfBB(&*BB) ) / NSECS_PER_CYCLE ) * (BBFreqFloat / LUF);        
-	}
+        // Unrolled by the factor its Loop allows (Trip Count, dependences).
+        if (BBFreqFloat > 1)
+          HardwareCostBB = getBBCost(&*BB).HWCycles * (BBFreqFloat / getUnrollFactorOfBB(&*BB, LUF));
         HardwareCostFunction   += HardwareCostBB;
       }
 
@@ -290,14 +653,21 @@ namespace {
     long int getHWCostOfFunction(Function *F) {
 
       long int HardwareCost =0;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI(); 
 
 
       // Populate worklist with Function's Basic Blocks and their respective BB's Frequencies. Both Per Iteration and Total.
       for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
 
         float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));         
-        HardwareCost   += ceil( ( getDelayOfBB(&*BB) ) / NSECS_PER_CYCLE ) * BBFreqFloat ;
+
+#ifdef LOOP_PIPELINING
+        double PipelinedCost;
+        if (getPipelinedCostOfBB(&*BB, BBFreqFloat, PipelinedCost)) {
+          HardwareCost += PipelinedCost;
+          continue;
+        }
+#endif
+        HardwareCost   += getBBCost(&*BB).HWCycles * BBFreqFloat ;
 
       }
 
@@ -314,7 +684,6 @@ namespace {
 
       float DelayOfFunction, DelayOfFunctionTotal = 0;
       long int HardwareCost =0;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI(); 
       std::vector<BasicBlock *> worklist, predecessor_bb, successor_bb;
       std::vector<float> BBFreqPerIter;
       std::vector<float> BBFreqTotal;
@@ -343,8 +712,8 @@ namespace {
         worklist.push_back(&*BB);
         BBFreqPerIter.push_back(BBFreqFloat);
         BBFreqTotal.push_back(BBFreq);
-        HWCostFunction.push_back(ceil( ( getDelayOfBB(&*BB) ) / NSECS_PER_CYCLE ) * BBFreqTotal[find_bb(worklist, &*BB)] ); // HW Cost for each BB (Cyclified) 
-        HWCostPath.push_back(ceil( ( getDelayOfBB(&*BB) ) / NSECS_PER_CYCLE ) * BBFreqTotal[find_bb(worklist, &*BB)] );  // maybe add static cast long int for BBFreqTotal
+        HWCostFunction.push_back(getBBCost(&*BB).HWCycles * BBFreqTotal[find_bb(worklist, &*BB)] ); // HW Cost for each BB (Cyclified) 
+        HWCostPath.push_back(getBBCost(&*BB).HWCycles * BBFreqTotal[find_bb(worklist, &*BB)] );  // maybe add static cast long int for BBFreqTotal
       }
 
       // Function has more than one BBs.
@@ -517,7 +886,7 @@ namespace {
       else {
         // DelayOfFunction      = getDelayOfBB(worklist[0]) * BBFreqPerIter[0];
         // DelayOfFunctionTotal = getDelayOfBB(worklist[0]) * BBFreqTotal[0];
-        HardwareCost   = ceil( ( getDelayOfBB(worklist[0]) ) / NSECS_PER_CYCLE ) * BBFreqTotal[0];
+        HardwareCost   = getBBCost(worklist[0]).HWCycles * BBFreqTotal[0];
       }
 
       return HardwareCost;
@@ -531,8 +900,6 @@ namespace {
     //
     long int logHWCostOfSuperFunction(Function *F,  int CurrentLevel) {
 
-      std::ifstream hw_file;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
       int CalleeFreq =0;
       int LevelSuperFunction=0;
       unsigned long long int HWCostSuperFunction=0;
@@ -555,96 +922,81 @@ namespace {
            if(CallInst *Call = dyn_cast<CallInst>(BI)) {
 
             
-            if (Call->getCalledFunction()) {
+            SmallVector<CallTarget, 4> Targets;
+            getCallTargets(Call, Targets);
 
-              if (!isSystemCall(Call->getCalledFunction())) {
+            for (unsigned t = 0; t < Targets.size(); t++) {
 
 
-                if (LevelSuperFunction == 0)
-                  LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
+              if (LevelSuperFunction == 0)
+                LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
 
 
-                float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-                //CalleeFreq = static_cast<int> (BBFreqFloat * 1);
-                CalleeFreq = static_cast<int> (BBFreqFloat * EntryCount); // Change 31/3/19
+              float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+              //CalleeFreq = static_cast<int> (BBFreqFloat * 1);
+              CalleeFreq = static_cast<int> (BBFreqFloat * EntryCount); // Change 31/3/19
 
-                Function *Calee = Call->getCalledFunction();
-                //std::string Calee_Name = Calee->getName();
-                std::string Calee_Name = GetValueName(Calee);
-                unsigned long long int HWCostCalee = 0;
-                double CalleeFreqRatio = 1;
+              Function *Calee = Targets[t].Calee;
+              //std::string Calee_Name = Calee->getName();
+              std::string Calee_Name = GetValueName(Calee);
+              unsigned long long int HWCostCalee = 0;
+              double CalleeFreqRatio = 1;
 
-                long int hw_latency;
-                int entry_count;
-                std::string fun_name;
-                bool found = false;
-                
-                for (int i = CurrentLevel-1; i>=0; i--) {
-                              
-                  hw_file.open("HW_" + std::to_string(i) + ".txt");
-                  if(hw_file.fail()) { // checks to see if file opended 
-                    errs() << "error" << "\n"; 
-                    return 1; // no point continuing if the file didn't open...
-                  } 
+              // Latest HW Cost of the Callee logged below the current Level. (Maximum Latency)
+              if (const LoggedCost *Logged = getLoggedCost(Calee, HW_COST, CurrentLevel)) {
 
-                  while(!hw_file.eof()) { 
-                    hw_file >> fun_name; // read first column number
-                    hw_file >> hw_latency; // read second column number
-                    hw_file >> entry_count; // read second column number
+                  long int hw_latency = Logged->Cost;
+                  int entry_count = Logged->EntryCount;
 
-                   if( Calee_Name == fun_name ){
-                    found = true;
-
-                    if (entry_count<=0)
-                      entry_count = 1;
-
-                    if (CalleeFreq<=0)
-                      CalleeFreq = 1;
-
-                    CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
-
-
-                      double intpart, fractpart;
+                  if (entry_count<=0)
+                    entry_count = 1;
 
-                      if (CalleeFreqRatio > 1) {
-                        //CalleeFreqRatio = 1;
-                        fractpart = modf (CalleeFreqRatio , &intpart);
-                        CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart;
-                      }
+                  if (CalleeFreq<=0)
+                    CalleeFreq = 1;
 
-                      if (Function_Name == "main" || Function_Name == "decode_main"  ) // Only for main
-                        CalleeFreqRatio=1;
+#ifndef CALL_SITE_FREQ
+                  CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
 
 
-                      HWCostCalee  =  hw_latency * CalleeFreqRatio;
-       
-                       errs()  << "---HW Cost2\t" << HWCostSuperFunction  << " " << HWCostCalee << " " << hw_latency
-                   << " " << CalleeFreq << " " << entry_count << " " << GetValueName(F) << " " << Calee_Name << " CalleeFreqRatio " 
-                    << format("%.8f",CalleeFreqRatio) <<  "\n\n" ;
-                      // errs() << "HW Cost Missing! \t" << fun_index << " " << Calee_Name << " " 
-                      //   << Function_HW_Cost_list[fun_index] << " file HW Cost " << hw_latency << " Freq : " << CalleeFreq << "\n";
+                    double intpart, fractpart;
 
+                    if (CalleeFreqRatio > 1) {
+                      //CalleeFreqRatio = 1;
+                      fractpart = modf (CalleeFreqRatio , &intpart);
+                      CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart;
                     }
-                      // errs()  << "--- this is a vicious circle\n" ;
-                  } // End of while    
 
-                   hw_file.close();
+                    if (Function_Name == "main" || Function_Name == "decode_main"  ) // Only for main
+                      CalleeFreqRatio=1;
+                    CalleeFreqRatio *= Targets[t].Share; // Of the calls of an indirect call.
+#else
+                    CalleeFreqRatio = getCallsPerEntry(Call, EntryCount) * Targets[t].Share;
+#endif
 
-                   if (found)
-                    break; // break when read from the top Level File. (Maximum Latency)
 
-                } // End of for
+                    HWCostCalee  =  hw_latency * CalleeFreqRatio;
+     
+                     errs()  << "---HW Cost2\t" << HWCostSuperFunction  << " " << HWCostCalee << " " << hw_latency
+                 << " " << CalleeFreq << " " << entry_count << " " << GetValueName(F) << " " << Calee_Name << " CalleeFreqRatio " 
+                  << format("%.8f",CalleeFreqRatio) <<  "\n\n" ;
+                    // errs() << "HW Cost Missing! \t" << fun_index << " " << Calee_Name << " " 
+                    //   << Function_HW_Cost_list[fun_index] << " file HW Cost " << hw_latency << " Freq : " << CalleeFreq << "\n";
 
-                HWCostSuperFunction += HWCostCalee; // Final Computation of HWCostSuperFunction
+              }
+
+              HWCostSuperFunction += HWCostCalee; // Final Computation of HWCostSuperFunction
 
-              } // End of If - System Call
             }
            }    // End of Call Instruction
          }      // End of For - BB Iterator
 
         } // End of For - Function Iterator
 
-      if (LevelSuperFunction == CurrentLevel &&  HWCostSuperFunction>0){
+      bool Logged = LevelSuperFunction == CurrentLevel &&  HWCostSuperFunction>0;
+      logSummary(F, HW_COST, CurrentLevel, Logged, HWCostSuperFunction, EntryCount);
+
+      if (Logged){
+#ifdef LOG_LEVEL_FILES
         errs() << "Writing to file " << CurrentLevel << "\n";
 
         myfile.open ("HW_" + std::to_string(CurrentLevel) + ".txt", std::ofstream::out | std::ofstream::app); 
@@ -653,6 +1005,7 @@ namespace {
             << EntryCount << "\t"
             <<"\n";
         myfile.close();    
+#endif
 
         errs() << "------HW Cost 3\t" << HWCostSuperFunction<< " " << " " << CalleeFreq << " " << GetValueName(F) << "\n\n";
       }
@@ -668,8 +1021,6 @@ namespace {
     //
     long int logHWCostOfSuperFunctionLUF(Function *F,  int CurrentLevel, unsigned int LUF) {
 
-      std::ifstream hw_file;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
       int CalleeFreq =0;
       int LevelSuperFunction=0;
       unsigned long long int HWCostSuperFunction=0;
@@ -685,346 +1036,308 @@ namespace {
         // Iterate inside the basic block.
         for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI){
            if(CallInst *Call = dyn_cast<CallInst>(BI)) {
-            if (Call->getCalledFunction()) {
-              if (!isSystemCall(Call->getCalledFunction())) {
-
-                if (LevelSuperFunction == 0)
-                  LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
-
-                float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-                CalleeFreq = static_cast<int> (BBFreqFloat * EntryCount); // Change 31/3/19
-                Function *Calee = Call->getCalledFunction();
-                std::string Calee_Name = GetValueName(Calee);
-                unsigned long long int HWCostCalee = 0;
-                double CalleeFreqRatio = 1;
-                long int hw_latency;
-                int entry_count;
-                std::string fun_name;
-                bool found = false;
-
-                for (int i = CurrentLevel-1; i>=0; i--) {
-                  hw_file.open("HW_" + std::to_string(i) + ".txt");
-                  if(hw_file.fail()) { // checks to see if file opended 
-                    errs() << "error" << "\n";
-                    return 1; // no point continuing if the file didn't open...
-                  }
+            SmallVector<CallTarget, 4> Targets;
+            getCallTargets(Call, Targets);
 
-                  while(!hw_file.eof()) {
-                    hw_file >> fun_name; // read first column number
-                    hw_file >> hw_latency; // read second column number
-                    hw_file >> entry_count; // read second column number
+            for (unsigned t = 0; t < Targets.size(); t++) {
 
-                   if( Calee_Name == fun_name ){
-                    found = true;
+              if (LevelSuperFunction == 0)
+                LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
 
-                    if (entry_count<=0)
-                      entry_count = 1;
+              float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+              CalleeFreq = static_cast<int> (BBFreqFloat * EntryCount); // Change 31/3/19
+              Function *Calee = Targets[t].Calee;
+              std::string Calee_Name = GetValueName(Calee);
+              unsigned long long int HWCostCalee = 0;
+              double CalleeFreqRatio = 1;
 
-                    if (CalleeFreq<=0)
-                      CalleeFreq = 1;
+              if (const LoggedCost *Logged = getLoggedCost(Calee, HW_COST, CurrentLevel)) {
 
-                    CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
-		                    CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
+                  long int hw_latency = Logged->Cost;
+                  int entry_count = Logged->EntryCount;
 
-                    double intpart, fractpart;
+                  if (entry_count<=0)
+                    entry_count = 1;
 
-                    if (CalleeFreqRatio > 1) {
-                        fractpart = modf (CalleeFreqRatio , &intpart);
-                        CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart;
-                      }
-                    if (Function_Name == "main" || Function_Name == "decode_main"  ) // Only for main
-                        CalleeFreqRatio=1;
+                  if (CalleeFreq<=0)
+                    CalleeFreq = 1;
 
-                      HWCostCalee  =  hw_latency * CalleeFreqRatio;
-                    }
-                  } // End of while    
-                   hw_file.close();
+#ifndef CALL_SITE_FREQ
+                  CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
+		                    CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
 
-                   if (found)
-                    break; // break when read from the top Level File. (Maximum Latency)
+                  double intpart, fractpart;
 
-                } // End of for
+                  if (CalleeFreqRatio > 1) {
+                      fractpart = modf (CalleeFreqRatio , &intpart);
+                      CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart;
+                    }
+                  if (Function_Name == "main" || Function_Name == "decode_main"  ) // Only for main
+                      CalleeFreqRatio=1;
+                  CalleeFreqRatio *= Targets[t].Share; // Of the calls of an indirect call.
+#else
+                  CalleeFreqRatio = getCallsPerEntry(Call, EntryCount) * Targets[t].Share;
+#endif
 
-                HWCostSuperFunction += HWCostCalee; // Final Computation of HWCostSuperFunction
-              } // End of If - System Call
+                    HWCostCalee  =  hw_latency * CalleeFreqRatio;
+              }
+
+              HWCostSuperFunction += HWCostCalee; // Final Computation of HWCostSuperFunction
             }
            }    // End of Call Instruction
          }      // End of For - BB Iterator
 
         } // End of For - Function Iterator
 
-      if (LevelSuperFunction == CurrentLevel &&  HWCostSuperFunction>0){
-        myfile.open ("HW_" + std::to_string(CurrentLevel) + ".txt", std::ofstream::out | std::ofstream::app);
-        myfile << Function_Name << "\t"
-            << HWCostSuperFunction << "\t"
-            << EntryCount << "\t"
-            <<"\n";
-        myfile.close();
-      }
+      // Not logged - HW_i keeps the costs of logHWCostOfSuperFunction.
       return HWCostSuperFunction;
     }
 
 #endif
 
-    // Lor SW estimation of the Super Function
-    // Detect calls to other functioms and add their SW cost as well.
+#ifdef CLOCK_SWEEP
+    // HW Cycles of BB at Clock, with every model of getCostOfBB, the Target
+    // clock set to the Clock while they are estimated.
     //
-    unsigned long long int logSWCostOfSuperFunction(Function *F, int CurrentLevel) {
+    double getClockCyclesOfBB(BasicBlock *BB, unsigned Clock) {
 
-      std::ifstream sw_file;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
-      int CalleeFreq, EntryCount;
-      int LevelSuperFunction=0;
-      unsigned long long int SWCostSuperFunction=0;
+      std::vector<double> &Cycles = Clock_Cycles_Cache[BB];
 
-      std::string Function_Name = GetValueName(F);  
-      EntryCount = getEntryCount(F);
-      CalleeFreq = EntryCount;
+      if (Cycles.empty()) {
+        float NSecsPerCycle = Target.NSecsPerCycle;
 
-      // Fix for function merged Apps - May remove it (H.264)
-      if (CalleeFreq==0)
-	CalleeFreq=1;	 
-	
-      SWCostSuperFunction = getSWCostOfFunction(F) * (CalleeFreq);
-      errs() << "--SW Cost1\t" << " Cost SuperF " << SWCostSuperFunction<< " CostF " << getSWCostOfFunction(F) << " Freq  " << CalleeFreq << " " << GetValueName(F) << "\n\n";
+        for (unsigned c = 0; c < Clocks.size(); c++) {
+          Target.NSecsPerCycle = Clocks[c];
+          Cycles.push_back(getCostOfBB(BB, Clock_Chained_Start_Cache[c]).HWCycles);
+        }
+        Target.NSecsPerCycle = NSecsPerCycle;
+      }
 
+      return Cycles[Clock];
+    }
 
-      for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
-        // Iterate inside the basic block.
-        for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI){
-         
-         if(CallInst *Call = dyn_cast<CallInst>(BI)) {
+    // HW Cost of the Function at Clock. (Average strategy)
+    //
+    long int getHWCostOfFunctionAtClock(Function *F, unsigned Clock) {
 
-    
-            if (Call->getCalledFunction()) {
+      long int HardwareCost = 0;
 
-              if (!isSystemCall(Call->getCalledFunction())) {
-                
-                if (LevelSuperFunction == 0)
-                  LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
+      for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
 
+        float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+        HardwareCost += getClockCyclesOfBB(&*BB, Clock) * BBFreqFloat;
+      }
 
-                float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
-                CalleeFreq = static_cast<int> (BBFreqFloat * EntryCount);
+      return HardwareCost;
+    }
 
-                Function *Calee = Call->getCalledFunction();
-                //std::string Calee_Name = Calee->getName();
-                std::string Calee_Name = GetValueName(Calee);
-                int fun_index = find_function(Function_list, Calee);
-                unsigned long long int SWCostCalee = 0;
-                double CalleeFreqRatio = 1;
+    // Log the HW Cost of the Super Function at Clock, the Callees added as in
+    // logHWCostOfSuperFunction with their Costs at the same Clock.
+    //
+    unsigned long long int logHWCostOfSuperFunctionAtClock(Function *F, int CurrentLevel, unsigned Clock) {
 
-                long int sw_latecy;
-                int entry_count;
-                std::string fun_name;
-                bool found = false;
-                
-              for (int i = CurrentLevel-1; i>=0; i--) {
-                            
-                sw_file.open("SW_" + std::to_string(i) + ".txt");
-                if(sw_file.fail()) { // checks to see if file opended 
-                  errs() << "error" << "\n"; 
-                  return 1; // no point continuing if the file didn't open...
-                } 
+      int LevelSuperFunction = 0;
+      std::string Function_Name = GetValueName(F);
+      int EntryCount = getEntryCount(F);
+      unsigned long long int HWCostSuperFunction = getHWCostOfFunctionAtClock(F, Clock);
 
-                while(!sw_file.eof()) { 
-                  sw_file >> fun_name; // read first column number
-                  sw_file >> sw_latecy; // read second column number
-                  sw_file >> entry_count; // read second column number
+      for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+        for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
 
-                  if( Calee_Name == fun_name ){
-                    found = true;
+          CallInst *Call = dyn_cast<CallInst>(BI);
+          if (!Call)
+            continue;
 
-                  if (entry_count<=0)
-                    entry_count = 1;
+          SmallVector<CallTarget, 4> Targets;
+          getCallTargets(Call, Targets);
 
-                    CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
+          for (unsigned t = 0; t < Targets.size(); t++) {
 
-                    double intpart, fractpart;
-                    if (CalleeFreqRatio > 1) { // Fixing CalleeFreqRatio in case it is over 1. 
-                      //CalleeFreqRatio = 1;
-                      fractpart = modf (CalleeFreqRatio , &intpart); // Receive the biggest part of the complimentary to one fractal part.
-                      CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart; 
-                    }
+            if (LevelSuperFunction == 0)
+              LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
 
-                    if (Function_Name == "main" || Function_Name == "decode_main") // Only for main and decode_main
-                      CalleeFreqRatio=1;
+            FunctionSummary &Calee_Summary = Summary_Table[Targets[t].Calee];
+            Calee_Summary.Clock_Costs.resize(Clocks.size());
 
-                    SWCostCalee  =  sw_latecy * CalleeFreqRatio;
-            
-                     errs()  << "---SW Cost2\t" << SWCostSuperFunction  << " " << SWCostCalee << " " << sw_latecy
-                       << " " << CalleeFreq << " " << entry_count << " " << GetValueName(F) << " " << Calee_Name << " CalleeFreqRatio " 
-                        << format("%.8f",CalleeFreqRatio) <<  "\n\n" ;
-                  }
-                } // End of while    
+            if (const LoggedCost *Logged = getLoggedCost(Calee_Summary.Clock_Costs[Clock], CurrentLevel)) {
 
-                 sw_file.close();
+#ifndef CALL_SITE_FREQ
+              float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+              int CalleeFreq = static_cast<int> (BBFreqFloat * EntryCount);
+              int entry_count = Logged->EntryCount <= 0 ? 1 : Logged->EntryCount;
+              double CalleeFreqRatio = (float) std::max(CalleeFreq, 1) / (float) entry_count;
+              double intpart, fractpart;
 
-                 if (found){
-                  errs() << "Found you!" << "\n";
-                  break; // break when read from the top Level File. (Maximum Latency)
-                 }
-               } // End of for
+              if (CalleeFreqRatio > 1) {
+                fractpart = modf (CalleeFreqRatio , &intpart);
+                CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart;
+              }
+              if (Function_Name == "main" || Function_Name == "decode_main"  ) // Only for main
+                CalleeFreqRatio = 1;
+              CalleeFreqRatio *= Targets[t].Share; // Of the calls of an indirect call.
+#else
+              double CalleeFreqRatio = getCallsPerEntry(Call, EntryCount) * Targets[t].Share;
+#endif
 
-                SWCostSuperFunction += SWCostCalee; // Final Computation of SWCostSuperFunction
+              HWCostSuperFunction += (unsigned long long int) (Logged->Cost * CalleeFreqRatio);
+            }
+          }
+        }
 
-              } // End of If - System Call
-            }           
-          }    // End of Call Instruction
-        }      // End of For - BB Iterator
-      }        // End of For - Function Iterator
+      FunctionSummary &Summary = Summary_Table[F];
+      Summary.Clock_Costs.resize(Clocks.size());
 
+      bool Logged = LevelSuperFunction == CurrentLevel && HWCostSuperFunction > 0;
+      logCost(Summary.Clock_Costs[Clock], CurrentLevel, Logged, HWCostSuperFunction, EntryCount);
 
-      if (LevelSuperFunction == CurrentLevel &&  SWCostSuperFunction>0){
-        errs() << "Writing to file " << CurrentLevel << "\n";
+      return HWCostSuperFunction;
+    }
+#endif
 
-        myfile.open ("SW_" + std::to_string(CurrentLevel) + ".txt", std::ofstream::out | std::ofstream::app); 
-        myfile << Function_Name << "\t" 
-            << SWCostSuperFunction << "\t"
-            << EntryCount << "\t"
-            <<"\n";
-        myfile.close();    
+#ifdef CALL_SITE_FREQ
+    // Times Call runs over the whole execution: the count of its !prof
+    // metadata (branch_weights, or the total of its value profile), else
+    // the entry count of its Function times the frequency of its BB.
+    //
+    double getCallSiteCount(CallInst *Call) {
 
-        errs() << "------SW Cost 3\t" << SWCostSuperFunction  << " " << CalleeFreq << " " << GetValueName(F) << "\n\n";
-      }
+      uint64_t Count;
+      if (Call->extractProfTotalWeight(Count))
+        return Count;
 
-      return SWCostSuperFunction;
+      BasicBlock *BB = Call->getParent();
+      float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+      return BBFreqFloat * getEntryCount(Call->getFunction());
     }
 
-
-    // Get the SW Cost estimation of the Super Function
-    // Detect calls to other functioms and add their SW cost as well.
+    // Share of the SW Cost of a Callee - over all of its CaleeEntryCount
+    // entries - that Call accounts for, when Target_Share of its calls reach
+    // the Callee. Never over 1, as the call sites of a Callee add up to its
+    // entries.
     //
-    unsigned long long int getSWCostOfSuperFunction(Function *F, int Level, float BBfreq, int EntryFuncFreq, unsigned long long int SWCostSuperFunction) {
+    double getCallSiteShare(CallInst *Call, int CaleeEntryCount, double Target_Share) {
 
+      return std::min(1.0, getCallSiteCount(Call) * Target_Share / std::max(CaleeEntryCount, 1));
+    }
 
-      std::ifstream sw_file ;
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
-      int CalleeFreq;
-      unsigned long long int SWCostSuperFunctionLocal=0;
-   
+    // Times Call runs per entry of its Function - what the HW Cost of a
+    // single run of the Callee is multiplied by. The BB frequency when the
+    // Function has no entry count.
+    //
+    double getCallsPerEntry(CallInst *Call, int EntryCount) {
 
-        if (Level > 0 )
-          return SWCostSuperFunction;
+      if (EntryCount <= 0) {
+        BasicBlock *BB = Call->getParent();
+        return static_cast<float>(static_cast<float>(BFI->getBlockFreq(BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+      }
+      return getCallSiteCount(Call) / EntryCount;
+    }
+#endif
 
+    // Lor SW estimation of the Super Function
+    // Detect calls to other functioms and add their SW cost as well.
+    //
+    unsigned long long int logSWCostOfSuperFunction(Function *F, int CurrentLevel) {
 
-      if (Level==0 || BBfreq == 0)
-        CalleeFreq = getEntryCount(F);      
-      else
-          CalleeFreq = static_cast<int> (BBfreq * EntryFuncFreq);
+      int CalleeFreq, EntryCount;
+      int LevelSuperFunction=0;
+      unsigned long long int SWCostSuperFunction=0;
 
-      //int CalleeFreq =  (CalleeFreq/2 +1);  // Fix!
+      std::string Function_Name = GetValueName(F);  
+      EntryCount = getEntryCount(F);
+      CalleeFreq = EntryCount;
 
-      errs() << "-SW Cost1\t" << SWCostSuperFunction<< " " << SWCostSuperFunctionLocal  << " " << CalleeFreq << " " << getSWCostOfFunction(F) << " " << GetValueName(F) << "\n\n";
-      SWCostSuperFunctionLocal = getSWCostOfFunction(F) * (CalleeFreq) ; // Fix!
-      SWCostSuperFunction+= SWCostSuperFunctionLocal;
-      errs() << "--SW Cost2\t" << SWCostSuperFunction<< " " << SWCostSuperFunctionLocal  << " " << CalleeFreq << " " << GetValueName(F) << "\n\n";
+      // Fix for function merged Apps - May remove it (H.264)
+      if (CalleeFreq==0)
+	CalleeFreq=1;	 
+	
+      SWCostSuperFunction = getSWCostOfFunction(F) * (CalleeFreq);
+      errs() << "--SW Cost1\t" << " Cost SuperF " << SWCostSuperFunction<< " CostF " << getSWCostOfFunction(F) << " Freq  " << CalleeFreq << " " << GetValueName(F) << "\n\n";
 
 
       for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
-
         // Iterate inside the basic block.
         for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI){
          
-           if(CallInst *Call = dyn_cast<CallInst>(BI)) {
-
-            
-            if (Call->getCalledFunction()) {
-
-              if (!isSystemCall(Call->getCalledFunction())) {
+         if(CallInst *Call = dyn_cast<CallInst>(BI)) {
 
-                Function *Calee = Call->getCalledFunction();
-                //std::string Calee_Name = Calee->getName();
-                std::string Calee_Name = GetValueName(Calee);
-                int fun_index = find_function(Function_list, Calee);
+    
+            SmallVector<CallTarget, 4> Targets;
+            getCallTargets(Call, Targets);
 
-                unsigned long long int SWCostCalee = 0;
+            for (unsigned t = 0; t < Targets.size(); t++) {
+              
+              if (LevelSuperFunction == 0)
+                LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
 
-                // /int CalleeEntryFreq = getEntryCount(Calee); 
-                double CalleeFreqRatio = 1;
 
-                    long int sw_latecy;
-                    int entry_count;
-                    std::string fun_name;
-                    
-                                
-                    sw_file.open("SW7.txt");
-                    if(sw_file.fail()) { // checks to see if file opended 
-                      errs() << "error" << "\n"; 
-                      return 1; // no point continuing if the file didn't open...
-                    } 
+              float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+              CalleeFreq = static_cast<int> (BBFreqFloat * EntryCount);
 
-                    while(!sw_file.eof()) { 
-                      sw_file >> fun_name; // read first column number
-                      sw_file >> sw_latecy; // read second column number
-                      sw_file >> entry_count; // read second column number
+              Function *Calee = Targets[t].Calee;
+              //std::string Calee_Name = Calee->getName();
+              std::string Calee_Name = GetValueName(Calee);
+              unsigned long long int SWCostCalee = 0;
+              double CalleeFreqRatio = 1;
 
-                      //errs() << " Open File!  "<< "\n";
-                     if( Calee_Name == fun_name ){//&& fun_name == "ProcessSlice" ) {
+              // Latest SW Cost of the Callee logged below the current Level. (Maximum Latency)
+              if (const LoggedCost *Logged = getLoggedCost(Calee, SW_COST, CurrentLevel)) {
 
-                        CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
+                  long int sw_latecy = Logged->Cost;
+                  int entry_count = Logged->EntryCount;
 
+                if (entry_count<=0)
+                  entry_count = 1;
 
-                        double intpart, fractpart;
+#ifndef CALL_SITE_FREQ
+                  CalleeFreqRatio =  (float)CalleeFreq / (float) entry_count;
 
-                        if (CalleeFreqRatio > 1) {
-                          fractpart = modf (CalleeFreqRatio , &intpart);
-                          CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart  ;
-                        }
+                  double intpart, fractpart;
+                  if (CalleeFreqRatio > 1) { // Fixing CalleeFreqRatio in case it is over 1. 
+                    //CalleeFreqRatio = 1;
+                    fractpart = modf (CalleeFreqRatio , &intpart); // Receive the biggest part of the complimentary to one fractal part.
+                    CalleeFreqRatio = fractpart > 1 - fractpart ? fractpart : 1 - fractpart; 
+                  }
 
+                  if (Function_Name == "main" || Function_Name == "decode_main") // Only for main and decode_main
+                    CalleeFreqRatio=1;
+                  CalleeFreqRatio *= Targets[t].Share; // Of the calls of an indirect call.
+#else
+                  CalleeFreqRatio = getCallSiteShare(Call, entry_count, Targets[t].Share);
+#endif
 
-                        SWCostCalee  =  sw_latecy * CalleeFreqRatio;// CalleeFreqRatio; //(CalleeFreq/2+1); // Fix
-                        //SWCostCalee  =  (sw_latecy) * (CalleeFreq/2+1); // Fix
-                         errs()  << "---SW Cost3\t" << SWCostSuperFunction  << " " << SWCostCalee << " " << (sw_latecy)
+                  SWCostCalee  =  sw_latecy * CalleeFreqRatio;
+          
+                   errs()  << "---SW Cost2\t" << SWCostSuperFunction  << " " << SWCostCalee << " " << sw_latecy
                      << " " << CalleeFreq << " " << entry_count << " " << GetValueName(F) << " " << Calee_Name << " CalleeFreqRatio " 
                       << format("%.8f",CalleeFreqRatio) <<  "\n\n" ;
-                        // errs() << "SW Cost Missing! \t" << fun_index << " " << Calee_Name << " " 
-                        //   << Function_SW_Cost_list[fun_index] << " file SW Cost " << sw_latecy << " Freq : " << CalleeFreq << "\n";
-
-                      }
-                    } // End of while    
-
-                     sw_file.close();      
-
-
-                   errs() << "----SW Cost4\t" << SWCostSuperFunction << " " << SWCostSuperFunctionLocal << " " << SWCostCalee 
-                     << " " << CalleeFreq << " " << GetValueName(F) << " " << Calee_Name << " Level " << Level  << " CalleeFreqRatio " 
-                     << format("%.8f",CalleeFreqRatio) << "\n\n";
+              }
 
-                  
-          
-                  
+              SWCostSuperFunction += SWCostCalee; // Final Computation of SWCostSuperFunction
 
-                    // errs() << "SW Cost 4 \t" << SWCostSuperFunction << " " << Calee->getName() << " "  
-                    //      << fun_index  <<" " << Function_SW_Cost_list[fun_index] << " Freq : " << CalleeFreq << "\n";
-                   // << " " << CalleeFreq/2 << " " << SWCostSuperFunction << "\n\n";
-    
-                    float BBFreqFloat = static_cast<float>(static_cast<float>(BFI->getBlockFreq(&*BB).getFrequency()) / static_cast<float>(BFI->getEntryFreq()));
+            }           
+          }    // End of Call Instruction
+        }      // End of For - BB Iterator
+      }        // End of For - Function Iterator
 
-                    Level++;
-                    SWCostCalee  += getSWCostOfSuperFunction(Calee, Level, BBFreqFloat, CalleeFreq, SWCostSuperFunction); // It is Zero in most calls within a Function.     
-                    Level--;
 
-                  //}
+      bool Logged = LevelSuperFunction == CurrentLevel &&  SWCostSuperFunction>0;
+      logSummary(F, SW_COST, CurrentLevel, Logged, SWCostSuperFunction, EntryCount);
 
-                    //SWCostSuperFunctionLocal +=SWCostCalee;
-                    //SWCostSuperFunction += SWCostSuperFunctionLocal;
-                    SWCostSuperFunction = SWCostCalee;
-                    //SWCostSuperFunction += SWCostSuperFunction;
-                     errs() << "------SW Cost5\t" << SWCostSuperFunction<< " " << SWCostSuperFunctionLocal << " " << SWCostCalee  
-                      << " " << CalleeFreq << " " << GetValueName(F) << " " << Calee_Name << "\n\n";
-              
-              }
-            }
-     
-           
-           } // End of Call Instruction
-         } // End of For - BB Iterator
+      if (Logged){
+#ifdef LOG_LEVEL_FILES
+        errs() << "Writing to file " << CurrentLevel << "\n";
 
-        } // End of For - Function Iterator
+        myfile.open ("SW_" + std::to_string(CurrentLevel) + ".txt", std::ofstream::out | std::ofstream::app); 
+        myfile << Function_Name << "\t" 
+            << SWCostSuperFunction << "\t"
+            << EntryCount << "\t"
+            <<"\n";
+        myfile.close();    
+#endif
 
-        //SWCostSuperFunction+= SWCostSuperFunctionLocal;
-        errs() << "------SW Cost 6\t" << SWCostSuperFunction<< " " << SWCostSuperFunctionLocal  << " " << CalleeFreq << " " << GetValueName(F) << "\n\n";
+        errs() << "------SW Cost 3\t" << SWCostSuperFunction  << " " << CalleeFreq << " " << GetValueName(F) << "\n\n";
+      }
 
       return SWCostSuperFunction;
     }
@@ -1032,7 +1345,6 @@ namespace {
 
    long int getSWCostOfFunction(Function *F) {
 
-      BlockFrequencyInfo *BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>().getBFI();
       long int Cost_Software_Function = 0;
 
       for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
@@ -1042,7 +1354,7 @@ namespace {
  
 
  // Calculate the Software Cost in Cycles multiplied with the respective frequency of the BB.
-        Cost_Software_BB = static_cast<long int> (getSWCostOfBB(&*BB) * BBFreqFloat);
+        Cost_Software_BB = static_cast<long int> (getBBCost(&*BB).SWCost * BBFreqFloat);
         Cost_Software_Function += Cost_Software_BB;
       }
 
@@ -1051,16 +1363,38 @@ namespace {
 
     }
 
+  // Get the Area extimation of a Function in LUTs.
+  //
+  unsigned int getAreaofFunction(Function *F){
+
+    unsigned int AreaofFunction = 0;
+
+    for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+      AreaofFunction += getBBCost(&*BB).Area;
+
+    return AreaofFunction;
+  }
+
+  // Get the Resources of a Function (LUTs, FFs, DSPs, BRAMs).
+  //
+  AreaVector getResourcesofFunction(Function *F) {
+
+    AreaVector Resources = AreaVector();
+
+    for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+      Resources += getBBCost(&*BB).Resources;
+
+    return Resources;
+  }
+
 #ifdef LOOP_LEVEL_PARALLELISM
   unsigned int getAreaofFunctionLUF(Function *F, unsigned int LUF) {
 
-    LoopInfo &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
     unsigned int AreaofFunction = 0, AreaOfBB = 0;
 
     for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
-        AreaOfBB = getAreaOfBBInFunction(BB);
-        if (Loop *L = LI.getLoopFor(&*BB))
-                AreaOfBB *=  LUF;
+        AreaOfBB = getBBCost(&*BB).Area;
+        AreaOfBB *= getUnrollFactorOfBB(&*BB, LUF);
 
       AreaofFunction += AreaOfBB;
 
@@ -1072,7 +1406,6 @@ namespace {
   //
   unsigned int logAreaofSuperFunctionLUF(Function *F, int CurrentLevel,  unsigned int LUF) {
 
-    std::ifstream area_file;
     int LevelSuperFunction=0;
     unsigned int AreaofSuperFunction = 0;
 
@@ -1085,53 +1418,25 @@ namespace {
 
            if(CallInst *Call = dyn_cast<CallInst>(BI)) {
 
-            if (Call->getCalledFunction()) {
-
-              if (!isSystemCall(Call->getCalledFunction())) {
-
-                if (LevelSuperFunction == 0)
-                  LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
-
-                Function *Calee = Call->getCalledFunction();
-                std::string Calee_Name = GetValueName(Calee);
-                unsigned long long int AreaCostCalee = 0;
-
-                if (find_function(Function_Area_list, Calee) == -1) {
-                  Function_Area_list.push_back(Calee);
-
-                  long int area;
-                  std::string fun_name;
-                  bool found = false;
+            SmallVector<CallTarget, 4> Targets;
+            getCallTargets(Call, Targets);
 
-                  for (int i = CurrentLevel-1; i>=0; i--) {
-                    area_file.open("AREA_" + std::to_string(i) + ".txt");
-                    if(area_file.fail()) { // checks to see if file opended 
-                      errs() << "error" << "\n";
-                      return 1; // no point continuing if the file didn't open...
-                    }
-
-                    while(!area_file.eof()) {
-                      area_file >> fun_name; // read first column number
-                      area_file >> area; // read second column number
+            for (unsigned t = 0; t < Targets.size(); t++) {
 
-                      if( Calee_Name == fun_name ){
-                        found = true;
+              if (LevelSuperFunction == 0)
+                LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
 
-                        AreaCostCalee  =  area;
-                      }
-                    } // End of while    
+              Function *Calee = Targets[t].Calee;
+              std::string Calee_Name = GetValueName(Calee);
+              unsigned long long int AreaCostCalee = 0;
 
-                    area_file.close();
+              if (Function_Area_list.insert(Calee).second) {
 
-                    if (found){
-                      errs() << "Found you!" << "\n";
-                      break; // break when read from the top Level File. (Maximum Latency)
-                    }
-                  } // End of for
+                if (const LoggedCost *Logged = getLoggedCost(Calee, AREA_COST, CurrentLevel))
+                  AreaCostCalee  =  Logged->Cost;
 
-                  AreaofSuperFunction += AreaCostCalee; // Final Computation of AreaofSuperFunction
+                AreaofSuperFunction += AreaCostCalee; // Final Computation of AreaofSuperFunction
               }
-              } // End of If - System Call
             }
 
            } // End of Call Instruction 
@@ -1140,30 +1445,25 @@ namespace {
 
         } // End of For - Function Iterator
 
-      if (LevelSuperFunction == CurrentLevel &&  AreaofSuperFunction>0 && LUF == 1){
-        myfile.open ("AREA_" + std::to_string(CurrentLevel) + ".txt", std::ofstream::out | std::ofstream::app);
-        myfile << Function_Name << "\t"
-            << AreaofSuperFunction << "\t"
-            <<"\n";
-        myfile.close();
-      }
+    // Not logged - AREA_i keeps the Areas of logAreaofSuperFunction.
     return AreaofSuperFunction;
   }
 
 
 #endif
  
-  // Get the Area extimation of a Super Function in LUTs.
+  // Get the Area extimation of a Super Function in LUTs, and in Resources
+  // every FPGA resource it takes.
   //
-  unsigned int logAreaofSuperFunction(Function *F, int CurrentLevel) {
+  unsigned int logAreaofSuperFunction(Function *F, int CurrentLevel, AreaVector &Resources) {
 
-    std::ifstream area_file;
     int LevelSuperFunction=0;
     unsigned int AreaofSuperFunction = 0;
 
     std::string Function_Name = GetValueName(F);  
 
     AreaofSuperFunction = getAreaofFunction(F);
+    Resources = getResourcesofFunction(F);
     errs() << "-Area  Cost1\t" << AreaofSuperFunction<< " " << getAreaofFunction(F)  << " " << GetValueName(F) << "\n\n";
 
     for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
@@ -1172,62 +1472,34 @@ namespace {
 
            if(CallInst *Call = dyn_cast<CallInst>(BI)) {
             
-            if (Call->getCalledFunction()) {
-
-              if (!isSystemCall(Call->getCalledFunction())) {
-
-                if (LevelSuperFunction == 0)
-                  LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
-
-
-                Function *Calee = Call->getCalledFunction();
-                //std::string Calee_Name = Calee->getName();
-                std::string Calee_Name = GetValueName(Calee);
-                unsigned long long int AreaCostCalee = 0;
+            SmallVector<CallTarget, 4> Targets;
+            getCallTargets(Call, Targets);
 
-                if (find_function(Function_Area_list, Calee) == -1) {
-                
-
-                  Function_Area_list.push_back(Calee);
+            for (unsigned t = 0; t < Targets.size(); t++) {
 
-                  long int area;
-                  std::string fun_name;
-                  bool found = false;
-                  
-                  for (int i = CurrentLevel-1; i>=0; i--) {
-                              
-                    area_file.open("AREA_" + std::to_string(i) + ".txt");
-                    if(area_file.fail()) { // checks to see if file opended 
-                      errs() << "error" << "\n"; 
-                      return 1; // no point continuing if the file didn't open...
-                    } 
+              if (LevelSuperFunction == 0)
+                LevelSuperFunction = CurrentLevel; // Assign the right Level of Calling Functions
 
-                    while(!area_file.eof()) { 
-                      area_file >> fun_name; // read first column number
-                      area_file >> area; // read second column number
 
-                      if( Calee_Name == fun_name ){
-                        found = true;
+              Function *Calee = Targets[t].Calee;
+              //std::string Calee_Name = Calee->getName();
+              std::string Calee_Name = GetValueName(Calee);
+              unsigned long long int AreaCostCalee = 0;
 
+              if (Function_Area_list.insert(Calee).second) {
 
-                        AreaCostCalee  =  area;
-                
-                        errs()  << "---AREA Cost2\t" << AreaofSuperFunction  << " " << AreaCostCalee << " " << area
-                           << " " << GetValueName(F) << " " << Calee_Name  <<  "\n\n" ;
-                      }
-                    } // End of while    
+                // Latest Area of the Callee logged below the current Level.
+                if (const LoggedCost *Logged = getLoggedCost(Calee, AREA_COST, CurrentLevel)) {
 
-                    area_file.close();
+                  AreaCostCalee  =  Logged->Cost;
+                  Resources += Summary_Table[Calee].Resources[CurrentLevel-1];
 
-                    if (found){
-                      errs() << "Found you!" << "\n";
-                      break; // break when read from the top Level File. (Maximum Latency)
-                    }
-                  } // End of for
+                  errs()  << "---AREA Cost2\t" << AreaofSuperFunction  << " " << AreaCostCalee << " " << Logged->Cost
+                     << " " << GetValueName(F) << " " << Calee_Name  <<  "\n\n" ;
+                }
 
-                  AreaofSuperFunction += AreaCostCalee; // Final Computation of AreaofSuperFunction
+                AreaofSuperFunction += AreaCostCalee; // Final Computation of AreaofSuperFunction
               }
-              } // End of If - System Call
             }
                             
            } // End of Call Instruction 
@@ -1237,7 +1509,12 @@ namespace {
         } // End of For - Function Iterator
 
 
-      if (LevelSuperFunction == CurrentLevel &&  AreaofSuperFunction>0){
+      bool Logged = LevelSuperFunction == CurrentLevel &&  AreaofSuperFunction>0;
+      logSummary(F, AREA_COST, CurrentLevel, Logged, AreaofSuperFunction, 0);
+      logResources(F, CurrentLevel, Logged, Resources);
+
+      if (Logged){
+#ifdef LOG_LEVEL_FILES
         errs() << "Writing to file " << CurrentLevel << "\n";
 
         myfile.open ("AREA_" + std::to_string(CurrentLevel) + ".txt", std::ofstream::out | std::ofstream::app); 
@@ -1246,6 +1523,7 @@ namespace {
             //<< EntryCount << "\t"
             <<"\n";
         myfile.close();    
+#endif
 
         errs() << "------AREA Cost 3\t" << AreaofSuperFunction   << " " << GetValueName(F) << "\n\n";
       }
@@ -1281,11 +1559,14 @@ namespace {
     virtual void getAnalysisUsage(AnalysisUsage& AU) const override {
               
         AU.addRequired<LoopInfoWrapperPass>();
-        AU.addRequired<RegionInfoPass>();
-       // AU.addRequired<DependenceAnalysis>();
-        AU.addRequiredTransitive<RegionInfoPass>();
-        AU.addRequiredTransitive<ScalarEvolutionWrapperPass>();
+#ifdef LOOP_LEVEL_PARALLELISM
+        AU.addRequired<ScalarEvolutionWrapperPass>();
+        AU.addRequired<DependenceAnalysisWrapperPass>();
+#endif
         AU.addRequired<BlockFrequencyInfoWrapperPass>();
+#ifdef SW_COST_TTI
+        AU.addRequired<TargetTransformInfoWrapperPass>();
+#endif
         AU.setPreservesAll();
     } 
   };
@@ -22,54 +22,44 @@ using namespace llvm;
 std::ofstream myfile; // File that Region Info are written.
 
 #define M_AXI_ARRAY 700                     // LUTs per M_AXI bus array.
-#define NSECS_PER_CYCLE         10         // nSecs Per Cycle 100 MHz.
+#define NSECS_PER_CYCLE         10         // nSecs Per Cycle 100 MHz (default Target).
+#define MEM_PORTS                2         // Loads/Stores a pipelined Loop issues per Cycle.
 #define SYS_AWARE
+//#define LIST_SCHEDULING // HW Cycles and Area of a BB from a list schedule on the FUs below.
 
-namespace {
+#define FU_ADDERS                4         // Adders/Subtractors/Comparators per BB.
+#define FU_MULTIPLIERS           2         // Multipliers (DSPs) per BB.
+#define FU_DIVIDERS              1         // Dividers (Div/Rem, not pipelined) per BB.
 
-static std::string GetValueName(const Value *V) {
-  if (V) {
-    std::string name;
-    raw_string_ostream namestream(name);
-    V->printAsOperand(namestream, false);
-    return namestream.str();
-  } else
-    return "[null]";
-}
+//#define MEMORY_PORT_MODEL // Loads/Stores scheduled on the ports of the array they access.
 
-  int find_inst(std::vector<Instruction *> list, Instruction *inst) {
+#define BRAM_PORTS               2         // Ports of a local array (dual-port BRAM).
+#define BRAM_LATENCY             1         // Cycles of a BRAM access.
+#define M_AXI_PORTS              1         // Accesses per Cycle of an M_AXI bus array.
+#define M_AXI_LATENCY           10         // Cycles of an M_AXI access - pipelined, a burst
+                                           // of N accesses takes M_AXI_LATENCY + N - 1.
 
-    for (unsigned i = 0; i < list.size(); i++)
-      if (list[i] == inst)
-        return i;
-    
-  
-    return -1;
-  }
+//#define BIT_WIDTH_AWARE // HW Delay and Area scaled to the bit width of each operation.
 
+#define TARGET_WIDTH            32         // Bit width the Target costs are given for.
+#define DSP_MUL_THRESHOLD       10         // Multipliers wider than this (bits) map to DSPs.
+#define DSP_WIDTH               27         // Operand bits of a DSP slice - wider ones cascade.
+#define LUT_MUL_AREA           618         // LUTs of a TARGET_WIDTH multiplier in the fabric.
 
-  int find_function(std::vector<Function *> list, Function *Fun) {
+#define BRAM_BITS            18432         // Bits of a BRAM (18Kb).
+#define BRAM_MIN_BITS         1024         // Smaller local arrays are kept in registers.
 
-    for (unsigned i = 0; i < list.size(); i++)
-      if (list[i] == Fun)
-        return i;
-      
-    
-    return -1;
-  }
+//#define SW_COST_TTI // SW Cycles of a BB from the TargetTransformInfo costs of the host
+                      // (the Target of opt, e.g. -mtriple=x86_64-unknown-linux-gnu -mcpu=skylake).
 
-  int find_function_name(std::vector<StringRef> list, StringRef Fun_name) {
+//#define OPERATION_CHAINING // HW Cycles of a BB from its operations packed into clock periods,
+                             // chained on from the BB before in straight-line code.
 
-    for (unsigned i = 0; i < list.size(); i++)
-      if (list[i] == Fun_name)
-        return i;
-      
-    
-    return -1;
-  }
+#include "AccelSeekerCommon.h" // Shared with the AccelSeekerIO pass.
 
+namespace {
 
-  float get_max(std::vector<float> DelayPaths) {
+  float get_max(const std::vector<float> &DelayPaths) {
 
     float max =0;
 
@@ -295,1119 +285,1310 @@ static std::string GetValueName(const Value *V) {
 
   }
 
-  //===---------------------------------------------------===//
-  //
-  //  Delay SW Estimation for each DFG Node/Istruction in Cycles. **NEW FEATURE**
+  // Strongly Connected Components of the app's call graph in post-order,
+  // so that every Function is listed after the Functions it calls. (Tarjan)
+  // Roots are taken in Module order to keep the traversal deterministic.
   //
-  //===---------------------------------------------------===//
+  void getCallGraphSCCs(Module &M, std::vector<std::vector<Function *> > &SCCs) {
 
-  float getCycleSWDelayEstim(Instruction *Inst)    
-   
-  {
+    struct DFSFrame {
+      Function *F;
+      std::vector<Function *> Callees;
+      unsigned NextCallee;
+    };
 
-    switch (Inst->getOpcode()) {
+    DenseMap<Function *, unsigned> DFSIndex, LowLink;
+    DenseMap<Function *, bool> OnStack;
+    std::vector<Function *> SCCStack;
+    std::vector<DFSFrame> DFSStack;
+    unsigned NextIndex = 0;
 
-    case Instruction::GetElementPtr: 
-      return 0;
+    auto pushFunction = [&](Function *F) {
+      DFSIndex[F] = LowLink[F] = NextIndex++;
+      SCCStack.push_back(F);
+      OnStack[F] = true;
+      DFSStack.push_back(DFSFrame{F, std::vector<Function *>(), 0});
+      getCalledFunctions(F, DFSStack.back().Callees, false);
+    };
 
-    case Instruction::Br:
-      return 1;
+    for (Module::iterator FI = M.begin(), FE = M.end(); FI != FE; ++FI) {
 
-    case Instruction::Alloca:
-      return 1;
+      Function *Root = &*FI;
 
-    case Instruction::PHI:
-      return 1;
+      if (Root->isDeclaration() || isSystemCall(Root) || DFSIndex.count(Root))
+        continue;
 
-    case Instruction::Store:
-      return 1;
+      pushFunction(Root);
 
-    case Instruction::Load:
-      return 1;
+      while (!DFSStack.empty()) {
 
-    case Instruction::Call:
-      return 1;
+        Function *F = DFSStack.back().F;
 
-    case Instruction::Fence:
-      return 1;
+        // Visit the next Callee of the Function on top of the stack.
+        if (DFSStack.back().NextCallee < DFSStack.back().Callees.size()) {
+          Function *Calee = DFSStack.back().Callees[DFSStack.back().NextCallee++];
 
-    case Instruction::LandingPad:
-      return 1;
+          if (!DFSIndex.count(Calee))
+            pushFunction(Calee);
+          else if (OnStack[Calee])
+            LowLink[F] = std::min(LowLink[F], DFSIndex[Calee]);
+          continue;
+        }
 
-    case Instruction::AtomicCmpXchg:
-      return 1;
+        // All Callees visited - F is the root of an SCC.
+        if (LowLink[F] == DFSIndex[F]) {
+          std::vector<Function *> SCC;
+          Function *Member;
+          do {
+            Member = SCCStack.back();
+            SCCStack.pop_back();
+            OnStack[Member] = false;
+            SCC.push_back(Member);
+          } while (Member != F);
+
+          std::reverse(SCC.begin(), SCC.end()); // Keep the discovery order.
+          SCCs.push_back(SCC);
+        }
 
-    case Instruction::AtomicRMW: 
-      return 1;
+        DFSStack.pop_back();
+        if (!DFSStack.empty()) {
+          Function *Caller = DFSStack.back().F;
+          LowLink[Caller] = std::min(LowLink[Caller], LowLink[F]);
+        }
+      }
+    }
+  }
 
-    case Instruction::ExtractValue: 
-      return 1;
+  //===---------------------------------------------------===//
+  //
+  //  Target Description - HW Delay (nSecs), Area (LUTs) and SW Delay (Cycles)
+  //  of each DFG Node/Istruction, indexed by opcode.
+  //
+  //===---------------------------------------------------===//
 
-    case Instruction::InsertValue:
-      return 1;
+  // Relational ICmps get a slot of their own after the LLVM opcodes.
+  //
+  #define ICMP_RELATIONAL   Instruction::OtherOpsEnd
+  #define NUM_TARGET_OPS    (Instruction::OtherOpsEnd + 1)
+
+  struct TargetDescription {
+    float NSecsPerCycle;
+    float HWDelay[NUM_TARGET_OPS];   // nSecs (Switch: per level of compares).
+    unsigned int Area[NUM_TARGET_OPS]; // LUTs (Switch: per case).
+    float SWDelay[NUM_TARGET_OPS];   // Cycles.
+  };
+
+  // Compiled-in Target, the SYS_AWARE one or the standalone one. Opcodes not
+  // listed (casts, GEPs, shifts by a single value, ...) cost nothing.
+  //
+  TargetDescription getDefaultTarget() {
+
+    TargetDescription T = {};
+
+    T.NSecsPerCycle = NSECS_PER_CYCLE;
+
+#ifdef SYS_AWARE
+    T.HWDelay[Instruction::PHI]    = 4.3;   T.Area[Instruction::PHI]    = 16;
+    T.HWDelay[Instruction::Switch] = 4.3;   T.Area[Instruction::Switch] = 16;
+    T.HWDelay[Instruction::Add]    = 5.3;   T.Area[Instruction::Add]    = 32;
+    T.HWDelay[Instruction::FAdd]   = 5.3;   T.Area[Instruction::FAdd]   = 32;
+    T.HWDelay[Instruction::Sub]    = 5.3;   T.Area[Instruction::Sub]    = 32;
+    T.HWDelay[Instruction::FSub]   = 5.3;   T.Area[Instruction::FSub]   = 32;
+    T.HWDelay[Instruction::Mul]    = 8.5;   T.Area[Instruction::Mul]    = 0;   // DSPs.
+    T.HWDelay[Instruction::FMul]   = 8.5;   T.Area[Instruction::FMul]   = 0;   // DSPs.
+    T.HWDelay[Instruction::UDiv]   = 49.5;  T.Area[Instruction::UDiv]   = 320;
+    T.HWDelay[Instruction::SDiv]   = 53;    T.Area[Instruction::SDiv]   = 320;
+    T.HWDelay[Instruction::FDiv]   = 53;    T.Area[Instruction::FDiv]   = 320;
+    T.HWDelay[Instruction::URem]   = 52.6;  T.Area[Instruction::URem]   = 320;
+    T.HWDelay[Instruction::SRem]   = 55.4;  T.Area[Instruction::SRem]   = 320;
+    T.HWDelay[Instruction::FRem]   = 55.4;  T.Area[Instruction::FRem]   = 320;
+    T.HWDelay[Instruction::And]    = 4.3;   T.Area[Instruction::And]    = 32;
+    T.HWDelay[Instruction::Or]     = 4.3;   T.Area[Instruction::Or]     = 32;
+    T.HWDelay[Instruction::Xor]    = 4.3;   T.Area[Instruction::Xor]    = 32;
+    T.HWDelay[Instruction::Select] = 4.3;   T.Area[Instruction::Select] = 16;
+    T.HWDelay[Instruction::ICmp]   = 5;     T.Area[Instruction::ICmp]   = 11;  // Equality.
+    T.HWDelay[ICMP_RELATIONAL]     = 0;     T.Area[ICMP_RELATIONAL]     = 16;
+    T.HWDelay[Instruction::FCmp]   = 5;     T.Area[Instruction::FCmp]   = 16;
+#else
+    T.HWDelay[Instruction::PHI]    = 0.23;  T.Area[Instruction::PHI]    = 33;
+    T.HWDelay[Instruction::Switch] = 0.23;  T.Area[Instruction::Switch] = 33;
+    T.HWDelay[Instruction::Add]    = 0.92;  T.Area[Instruction::Add]    = 33;
+    T.HWDelay[Instruction::FAdd]   = 0.92;  T.Area[Instruction::FAdd]   = 33;
+    T.HWDelay[Instruction::Sub]    = 0.92;  T.Area[Instruction::Sub]    = 33;
+    T.HWDelay[Instruction::FSub]   = 0.92;  T.Area[Instruction::FSub]   = 33;
+    T.HWDelay[Instruction::Mul]    = 1;     T.Area[Instruction::Mul]    = 618;
+    T.HWDelay[Instruction::FMul]   = 1;     T.Area[Instruction::FMul]   = 618;
+    T.HWDelay[Instruction::UDiv]   = 3.76;  T.Area[Instruction::UDiv]   = 1056;
+    T.HWDelay[Instruction::SDiv]   = 3.76;  T.Area[Instruction::SDiv]   = 1185;
+    T.HWDelay[Instruction::FDiv]   = 3.76;  T.Area[Instruction::FDiv]   = 1185;
+    T.HWDelay[Instruction::URem]   = 4.04;  T.Area[Instruction::URem]   = 1312;
+    T.HWDelay[Instruction::SRem]   = 4.04;  T.Area[Instruction::SRem]   = 1312;
+    T.HWDelay[Instruction::FRem]   = 4.04;  T.Area[Instruction::FRem]   = 1312;
+    T.HWDelay[Instruction::And]    = 0.02;  T.Area[Instruction::And]    = 33;
+    T.HWDelay[Instruction::Or]     = 0.03;  T.Area[Instruction::Or]     = 33;
+    T.HWDelay[Instruction::Xor]    = 0.03;  T.Area[Instruction::Xor]    = 33;
+    T.HWDelay[Instruction::Select] = 0.23;  T.Area[Instruction::Select] = 33;
+    T.HWDelay[Instruction::ICmp]   = 0.15;  T.Area[Instruction::ICmp]   = 12;  // Equality.
+    T.HWDelay[ICMP_RELATIONAL]     = 0;     T.Area[ICMP_RELATIONAL]     = 17;
+    T.HWDelay[Instruction::FCmp]   = 0.15;  T.Area[Instruction::FCmp]   = 17;
+#endif
+
+    // SW - one Cycle for the Instructions below, more for the ones after
+    // them, none for the rest (GEPs, casts, shifts by a single value, ...).
+    const unsigned OneCycleSW[] = {
+      Instruction::Br, Instruction::Alloca, Instruction::PHI, Instruction::Store, Instruction::Load,
+      Instruction::Call, Instruction::Fence, Instruction::LandingPad, Instruction::AtomicCmpXchg,
+      Instruction::AtomicRMW, Instruction::ExtractValue, Instruction::InsertValue, Instruction::Switch,
+      Instruction::IndirectBr, Instruction::Invoke, Instruction::Resume, Instruction::Ret,
+      Instruction::ShuffleVector, Instruction::ExtractElement, Instruction::InsertElement,
+      Instruction::Add, Instruction::Sub, Instruction::Mul, Instruction::And, Instruction::Or,
+      Instruction::Xor, Instruction::Select, Instruction::ICmp, Instruction::FCmp };
+
+    for (unsigned i = 0; i < sizeof(OneCycleSW) / sizeof(OneCycleSW[0]); i++)
+      T.SWDelay[OneCycleSW[i]] = 1;
+
+    T.SWDelay[ICMP_RELATIONAL]     = 1;
+    T.SWDelay[Instruction::FAdd]   = 2;
+    T.SWDelay[Instruction::FSub]   = 2;
+    T.SWDelay[Instruction::FMul]   = 6;
+    T.SWDelay[Instruction::UDiv]   = 6;
+    T.SWDelay[Instruction::SDiv]   = 6;
+    T.SWDelay[Instruction::FDiv]   = 12;
+    T.SWDelay[Instruction::URem]   = 6;
+    T.SWDelay[Instruction::SRem]   = 6;
+    T.SWDelay[Instruction::FRem]   = 12;
+
+    return T;
+  }
 
-    case Instruction::Switch: // Similar as branching.
-      return 1;
-    
-    case Instruction::IndirectBr: 
-      return 1;
+  TargetDescription Target = getDefaultTarget(); // Read by all the estimators.
 
-    case Instruction::Invoke: 
-      return 1;
+  // Name of a Target opcode in the Target Description file - the LLVM name
+  // (e.g. "add", "fmul", "icmp" for equalities), "icmp.rel" for relational ICmps.
+  //
+  std::string getTargetOpName(unsigned Op) {
 
-    case Instruction::Resume: 
-      return 1;
+    if (Op == ICMP_RELATIONAL)
+      return "icmp.rel";
+    return Instruction::getOpcodeName(Op);
+  }
 
-    case Instruction::Unreachable: 
-      return 0;
+  // Load a Target Description file over the compiled-in Target. Lines:
+  //
+  //   NSECS_PER_CYCLE <nSecs>
+  //   <opcode> <HW Delay nSecs> <Area LUTs> <SW Delay Cycles>
+  //
+  // Opcodes not in the file keep their costs. False if the file is missing
+  // or a line is not understood.
+  //
+  bool loadTargetDescription(const std::string &FileName) {
 
-    case Instruction::Ret:
-      return 1;
+    std::ifstream target_file(FileName);
+    std::string line;
+    StringMap<unsigned> Opcodes;
 
-    case Instruction::ShuffleVector: // * more complex *
-      return 1;
+    if (target_file.fail())
+      return false;
 
-    case Instruction::ExtractElement:
-      return 1;
+    for (unsigned Op = Instruction::TermOpsBegin; Op < NUM_TARGET_OPS; Op++)
+      Opcodes[getTargetOpName(Op)] = Op;
 
-    case Instruction::InsertElement:
-      return 1;
+    while (std::getline(target_file, line)) {
 
-    case Instruction::Add:
-      return 1;
+      std::istringstream fields(line);
+      std::string name;
 
-    case Instruction::FAdd:
-      return 2;
+      if (!(fields >> name) || name[0] == '#')
+        continue;
 
-    case Instruction::Sub:
-      return 1;
+      if (name == "NSECS_PER_CYCLE") {
+        if (!(fields >> Target.NSecsPerCycle) || Target.NSecsPerCycle <= 0)
+          return false;
+        continue;
+      }
 
-    case Instruction::FSub:  // This is not modelled properly (Double as rough estimation)
-      return 2;
+      StringMap<unsigned>::iterator It = Opcodes.find(name);
+      if (It == Opcodes.end() ||
+          !(fields >> Target.HWDelay[It->second] >> Target.Area[It->second] >> Target.SWDelay[It->second]))
+        return false;
+    }
+    return true;
+  }
 
-    case Instruction::Mul:
-      return 1;
+  // Index of Inst in the Target tables.
+  //
+  unsigned getTargetOp(Instruction *Inst) {
 
-    case Instruction::FMul: // This is not modelled properly (Double as rough estimation)
+    if (ICmpInst *Icmp = dyn_cast<ICmpInst>(Inst))
+      if (!Icmp->isEquality())
+        return ICMP_RELATIONAL;
+    return Inst->getOpcode();
+  }
 
-    case Instruction::UDiv:
-      return 6;
+  // Delay SW Estimation for each DFG Node/Istruction in Cycles.
+  //
+  float getCycleSWDelayEstim(Instruction *Inst) {
 
-    case Instruction::SDiv:
-      return 6;
+    return Target.SWDelay[getTargetOp(Inst)];
+  }
 
-    case Instruction::FDiv: // This is not modelled properly (Double as rough estimation)
-      return 12;
+#ifdef BIT_WIDTH_AWARE
+  // Bit width of the operation of Inst - of its operands for compares,
+  // switches and stores, of its result otherwise - and the lanes of a vector.
+  // 0 when it has none (pointers, void), the Target costs are used as given.
+  //
+  unsigned getBitWidth(Instruction *Inst, unsigned &Lanes) {
 
-    case Instruction::URem:
-      return 6;
+    Type *Ty = Inst->getType();
 
-    case Instruction::SRem:
-      return 6;
+    if (isa<CmpInst>(Inst) || isa<SwitchInst>(Inst) || isa<StoreInst>(Inst))
+      Ty = Inst->getOperand(0)->getType();
 
-    case Instruction::FRem: // This is not modelled properly (Double as rough estimation)
-      return 12;
+    if (!Ty->isIntOrIntVectorTy() && !Ty->isFPOrFPVectorTy())
+      return Lanes = 0;
 
-    case Instruction::Shl: {
+    unsigned Width = Ty->getScalarSizeInBits();
+    unsigned Bits  = Ty->getPrimitiveSizeInBits();
 
-      Value *Operand_two = Inst->getOperand(1);
+    Lanes = Bits / Width;
+    return Width;
+  }
 
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
+  // Delay and Area curves over the bit width W of an operation, relative to
+  // the TARGET_WIDTH costs (r = W / TARGET_WIDTH):
+  //
+  //   Add/Sub/Cmp      - Delay * (1 + r) / 2 (carry chain), Area * r.
+  //   Logic/Select/PHI - Delay, Area * r (bit parallel).
+  //   Shifts           - Delay * log2(W) / log2(TARGET_WIDTH), Area * r * log2(W) / log2(TARGET_WIDTH).
+  //   Mul              - up to DSP_MUL_THRESHOLD bits in the fabric: Delay * r,
+  //                      LUT_MUL_AREA * r^2; wider on DSPs: Delay of the
+  //                      ceil(W / DSP_WIDTH) cascaded slices, Area as given.
+  //   Div/Rem          - Delay * r, Area * r^2.
+  //
+  // Vectors take the Area of every lane. Other opcodes keep their costs.
+  //
+  void scaleToBitWidth(Instruction *Inst, float &Delay, float &Area) {
 
-      return 1;
-    
-    }
-    
-    case Instruction::LShr: {
-      
-      Value *Operand_two = Inst->getOperand(1);
+    unsigned Lanes;
+    unsigned Width = getBitWidth(Inst, Lanes);
 
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-      
-      return 1;
-    }
+    if (Width == 0)
+      return;
 
-    case Instruction::AShr:{
-      
-      Value *Operand_two = Inst->getOperand(1);
+    float Ratio = (float) Width / TARGET_WIDTH;
+    float Levels = log2(std::max(2u, Width)) / log2(TARGET_WIDTH);
 
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-      
-      return 1;
-    }
+    switch (Inst->getOpcode()) {
 
-    case Instruction::And:
-      return 1;
+    case Instruction::Add:
+    case Instruction::Sub:
+    case Instruction::FAdd:
+    case Instruction::FSub:
+    case Instruction::ICmp:
+    case Instruction::FCmp:
+      Delay *= (1 + Ratio) / 2;
+      Area  *= Ratio;
+      break;
 
+    case Instruction::And:
     case Instruction::Or:
-      return 1;
-
     case Instruction::Xor:
-      return 1;
-
-    case Instruction::Select: // This is my estimation!
-      return 1;
+    case Instruction::Select:
+    case Instruction::PHI:
+    case Instruction::Switch:
+      Area  *= Ratio;
+      break;
 
-    case Instruction::ICmp: // Check type of ICmp. (Equality or Relational) 
-    {
-      ICmpInst *Icmp = dyn_cast<ICmpInst>(&*Inst);
+    case Instruction::Shl:
+    case Instruction::LShr:
+    case Instruction::AShr:
+      Delay *= Levels;
+      Area  *= Ratio * Levels;
+      break;
 
-      if (Icmp->isEquality())
-        return 1;
+    case Instruction::Mul:
+    case Instruction::FMul:
+      if (Width <= DSP_MUL_THRESHOLD) {
+        Delay *= Ratio;
+        Area   = LUT_MUL_AREA * Ratio * Ratio;
+      }
       else
-        return 1;       
-    }
-
-    case Instruction::FCmp: // This is my estimation!
-      return 1;
-
-    case Instruction::ZExt:
-      return 0;
+        Delay *= (float) ((Width + DSP_WIDTH - 1) / DSP_WIDTH) / ((TARGET_WIDTH + DSP_WIDTH - 1) / DSP_WIDTH);
+      break;
 
-    case Instruction::SExt:
-      return 0;
+    case Instruction::UDiv:
+    case Instruction::SDiv:
+    case Instruction::FDiv:
+    case Instruction::URem:
+    case Instruction::SRem:
+    case Instruction::FRem:
+      Delay *= Ratio;
+      Area  *= Ratio * Ratio;
+      break;
 
-    case Instruction::FPToUI:
-      return 0;
+    default:
+      return;
+    }
 
-    case Instruction::FPToSI:
-      return 0;
+    Area *= Lanes;
+  }
+#endif
 
-    case Instruction::FPExt:
-      return 0;
+  // Delay HW Estimation for each DFG Node/Istruction in nSecs.
+  // A Switch is a tree of compares, ceil(log2(Number of Cases)) levels deep.
+  //
+  float getDelayEstim(Instruction *Inst) {
 
-    case Instruction::PtrToInt:
-      return 0;
+    float Delay = Target.HWDelay[getTargetOp(Inst)];
 
-    case Instruction::IntToPtr:
-      return 0;
+    if (SwitchInst *Switch = dyn_cast<SwitchInst>(Inst))
+      Delay *= ceil(log2(Switch->getNumCases()));
 
-    case Instruction::SIToFP:
-      return 0;
+#ifdef BIT_WIDTH_AWARE
+    float Area = 0;
+    scaleToBitWidth(Inst, Delay, Area);
+#endif
 
-    case Instruction::UIToFP:
-      return 0;
+    return Delay;
+  }
 
-    case Instruction::Trunc:
-      return 0;
+  // Area Estimation for each DFG Node/Istruction in LUTs.
+  // A Switch takes a compare per case.
+  //
+  unsigned int getAreaEstim(Instruction *Inst) {
 
-    case Instruction::FPTrunc:
-      return 0;
+    unsigned int Area = Target.Area[getTargetOp(Inst)];
 
-    case Instruction::BitCast:
-      return 0;
+    if (SwitchInst *Switch = dyn_cast<SwitchInst>(Inst))
+      Area *= Switch->getNumCases();
 
-    default:  // Assume default as 0.
-      return 0;
+#ifdef BIT_WIDTH_AWARE
+    float Delay = 0, AreaFloat = Area;
+    scaleToBitWidth(Inst, Delay, AreaFloat);
+    Area = ceil(AreaFloat);
+#endif
 
-    }// end of switch.
+    return Area;
   }
 
-  //===---------------------------------------------------===//
-  //
-  //
-  //  Delay HW Estimation for each DFG Node/Istruction in nSecs.
-  //
+  // Area of an Instruction, BB, Function or Super Function in every FPGA
+  // resource - LUT is the Area of getAreaEstim.
   //
-  //===---------------------------------------------------===//
-
-  float getDelayEstim(Instruction *Inst)
-  
-  {
+  struct AreaVector {
+    unsigned int LUT, FF, DSP, BRAM;
+
+    AreaVector &operator+=(const AreaVector &Other) {
+      LUT  += Other.LUT;
+      FF   += Other.FF;
+      DSP  += Other.DSP;
+      BRAM += Other.BRAM;
+      return *this;
+    }
+  };
 
-    switch (Inst->getOpcode()) {
+  // DSPs of a multiplier: ceil(W / DSP_WIDTH)^2 slices for W bits (the
+  // mantissa of FP ones) per lane, none up to DSP_MUL_THRESHOLD bits.
+  //
+  unsigned int getDSPEstim(Instruction *Inst) {
 
-    case Instruction::GetElementPtr: 
+    if (Inst->getOpcode() != Instruction::Mul && Inst->getOpcode() != Instruction::FMul)
       return 0;
 
-    case Instruction::Br:
-      return 0;
+    Type *Ty = Inst->getType();
+    Type *Scalar = Ty->getScalarType();
+    unsigned Width = Scalar->isFloatingPointTy() ? Scalar->getFPMantissaWidth() : Scalar->getScalarSizeInBits();
+    unsigned Bits  = Ty->getPrimitiveSizeInBits();
+    unsigned Lanes = Bits / Scalar->getScalarSizeInBits();
 
-    case Instruction::Alloca:
+    if (Width <= DSP_MUL_THRESHOLD)
       return 0;
 
-    case Instruction::PHI:
-    // #ifdef OLD_SETUP
-    //   return 5.299;
-    // #endif
-    #ifdef SYS_AWARE
-      return 4.3;
-    #else
-      return 0.23;
-    #endif    
-
-    case Instruction::Store:
-      return 0;
-
-    case Instruction::Load:
-      return 0;
-
-    case Instruction::Call:
-      return 0;
+    unsigned Slices = (Width + DSP_WIDTH - 1) / DSP_WIDTH;
+    return Slices * Slices * Lanes;
+  }
 
-    case Instruction::Fence:
-      return 0;
+  // Resources of an Instruction: its LUTs, a register (FFs) for its result
+  // when it takes HW, its DSPs and, for a local array of more than
+  // BRAM_MIN_BITS, the BRAMs that hold it.
+  //
+  AreaVector getResourceEstim(Instruction *Inst) {
 
-    case Instruction::LandingPad:
-      return 0;
+    AreaVector Area = {getAreaEstim(Inst), 0, getDSPEstim(Inst), 0};
 
-    case Instruction::AtomicCmpXchg:
-      return 0;
+    if (AllocaInst *Alloca = dyn_cast<AllocaInst>(Inst)) {
+      if (ConstantInt *Size = dyn_cast<ConstantInt>(Alloca->getArraySize())) {
+        uint64_t Bits = Inst->getModule()->getDataLayout().getTypeAllocSizeInBits(Alloca->getAllocatedType());
+        Bits *= Size->getZExtValue();
+        if (Bits > BRAM_MIN_BITS)
+          Area.BRAM = (Bits + BRAM_BITS - 1) / BRAM_BITS;
+      }
+      return Area;
+    }
 
-    case Instruction::AtomicRMW: 
-      return 0;
+    if (Area.LUT > 0 || Area.DSP > 0) {
+      unsigned Bits = Inst->getType()->getPrimitiveSizeInBits();
+      Area.FF = Bits;
+    }
+    return Area;
+  }
 
-    case Instruction::ExtractValue: 
-      return 0;
+    // Get Area Estimation for a Block iterator of a Function.
+  unsigned int getAreaOfBBInFunction(Function::iterator &BB) {
 
-    case Instruction::InsertValue:
-      return 0;
+    unsigned int AreaOfBB = 0;
 
-    case Instruction::Switch: // ceil(log2(Number of Cases)) * 5.2999
-    {
-
-      SwitchInst *Switch = dyn_cast<SwitchInst>(&*Inst);
-      unsigned int NumCases = Switch->getNumCases();
-      // #ifdef OLD_SETUP
-      //   return ceil(log2(NumCases)) * 5.2999 ;
-      // #endif
-      #ifdef SYS_AWARE
-        return ceil(log2(NumCases)) * 4.3 ;
-      #else
-      return ceil(log2(NumCases)) * 0.23 ;
-      #endif
-    }
-      
-    case Instruction::IndirectBr: 
-      return 0;
+    // Iterate inside the basic block.
+    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
+      AreaOfBB += getAreaEstim(&*BI);
 
-    case Instruction::Invoke: 
-      return 0;
+    return AreaOfBB;
+  }
 
-    case Instruction::Resume: 
-      return 0;
+    // SW Cost in Cycles estimation for a single BB. (Without Frequency of each BB)
+  //
+  long int getSWCostOfBB(BasicBlock *BB) {
 
-    case Instruction::Unreachable: 
-      return 0;
+    long int SWCostBB = 0;
 
-    case Instruction::Ret:
-      return 0;
+    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
+      SWCostBB += getCycleSWDelayEstim(&*BI);
 
-    case Instruction::ShuffleVector:
-      return 0;
 
-    case Instruction::ExtractElement:
-      return 0;
+    return SWCostBB;
+  }
 
-    case Instruction::InsertElement:
-      return 0;
 
+ // Data Flow Graph of a BB. Nodes are the Instructions in program order.
+  // Edges go from an operand to its user (Send_Node --> Receive_Node), so
+  // they never point backwards - except for a PHI fed by itself.
+  //
+  struct BBDataFlowGraph {
+    std::vector<Instruction *> Nodes;
+    std::vector<SmallVector<unsigned, 4> > Succs; // Receive Nodes of each Node.
+    std::vector<bool> SelfEdge;
+    unsigned NumEdges;
+  };
+
+  // Build the DFG of a BB in one pass over Instructions and Operands.
+  //
+  void getDataFlowGraphOfBB(BasicBlock *BB, BBDataFlowGraph &DFG) {
 
-    case Instruction::Add:
-      // #ifdef OLD_SETUP
-      //   return 9.323;
-      // #endif
-      #ifdef SYS_AWARE
-        return 5.3;
-      #else
-      return 0.92;
-      #endif
-
-    case Instruction::FAdd: // This is not modelled properly. Or mark as forbidden.
-      // #ifdef OLD_SETUP
-      //   return 9.323;
-      // #endif
-      #ifdef SYS_AWARE
-        return 5.3;
-      #else
-      return 0.92;
-      #endif
+    DenseMap<Instruction *, unsigned> Index;
 
-    case Instruction::Sub:
-      // #ifdef OLD_SETUP
-      //   return 9.323;
-      // #endif
-      #ifdef SYS_AWARE
-        return 5.3;
-      #else
-      return 0.92;
-      #endif
-
-    case Instruction::FSub: // This is not modelled properly. Or mark as forbidden.
-      // #ifdef OLD_SETUP
-      //   return 9.323;
-      // #endif
-      #ifdef SYS_AWARE
-        return 5.3;
-      #else
-      return 0.92;
-      #endif
+    DFG.Nodes.clear();
+    DFG.NumEdges = 0;
 
-    case Instruction::Mul:
-    // #ifdef OLD_SETUP
-    //   return 9.9;
-    // #endif
-      #ifdef SYS_AWARE
-        return 8.5;
-      #else
-        return 1;
-      #endif
-
-    case Instruction::FMul:  // This is not modelled proerly. Or mark as forbidden.
-      // #ifdef OLD_SETUP
-      //   return 9.9;
-      // #endif
-      #ifdef SYS_AWARE
-        return 8.5;
-      #else
-      return 1;
-      #endif
+    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
+      Index[&*BI] = DFG.Nodes.size();
+      DFG.Nodes.push_back(&*BI);
+    }
 
-    case Instruction::UDiv:
-      // #ifdef OLD_SETUP
-      //   return 59.535;
-      // #endif
-      #ifdef SYS_AWARE
-        return 49.5;
-      #else
-      return 3.76;
-      #endif
-    
-    case Instruction::SDiv:
-      // #ifdef OLD_SETUP
-      //   return 59.7;
-      // #endif
-      #ifdef SYS_AWARE
-        return 53;
-      #else
-      return 3.76;
-      #endif
+    DFG.Succs.assign(DFG.Nodes.size(), SmallVector<unsigned, 4>());
+    DFG.SelfEdge.assign(DFG.Nodes.size(), false);
 
-    case Instruction::FDiv:
-      // #ifdef OLD_SETUP
-      //   return 59.7;
-      // #endif
-      #ifdef SYS_AWARE
-        return 53;
-      #else
-      return 3.76;
-      #endif
+    for (unsigned i = 0; i < DFG.Nodes.size(); i++) {
 
-    case Instruction::URem:
-      // #ifdef OLD_SETUP
-      //   return 59.636;
-      // #endif
-      #ifdef SYS_AWARE
-        return 52.6;
-      #else
-      return 4.04;
-      #endif
+      Instruction *Inst = DFG.Nodes[i];
 
-    case Instruction::SRem:
-      // #ifdef OLD_SETUP
-      //   return 59.636;
-      // #endif
-      #ifdef SYS_AWARE
-        return 55.4;
-      #else
-      return 4.04;
-      #endif
+      // Iterate over each operand of each Instruction.
+      for (unsigned int op=0; op<Inst->getNumOperands(); op++) {
 
-    case Instruction::FRem:
-      // #ifdef OLD_SETUP
-      //   return 59.636;
-      // #endif
-      #ifdef SYS_AWARE
-        return 55.4;
-      #else
-      return 4.04;
-      #endif
-
-    case Instruction::Shl:{
-
-      Value *Operand_two = Inst->getOperand(1);
-
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-
-      // #ifdef OLD_SETUP
-      //   return 8.862;
-      // #endif
-      #ifdef SYS_AWARE
-        return 5.5;
-      #else
-      return 0.71;
-      #endif
-    
-    }
-    
-    case Instruction::LShr: {
-      
-      Value *Operand_two = Inst->getOperand(1);
+        if (PHINode *phi = dyn_cast<PHINode>(Inst))
+          if (phi->getIncomingBlock(op) != BB)
+            continue;
 
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-      
-      // #ifdef OLD_SETUP
-      //   return 8.862;
-      // #endif
-      #ifdef SYS_AWARE
-        return 5.5;
-      #else
-      return 0.73;
-      #endif
-    }
+        Instruction *Inst_source = dyn_cast<Instruction>(Inst->getOperand(op));
+        if (!Inst_source || Inst_source->getParent() != BB)
+          continue;
 
-    case Instruction::AShr:{
-      
-      Value *Operand_two = Inst->getOperand(1);
+        unsigned Source = Index[Inst_source];
+        if (Source > i) // Only values defined up to the Instruction itself.
+          continue;
 
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-      
-      // #ifdef OLD_SETUP
-      //   return 9.052;
-      // #endif
-      #ifdef SYS_AWARE
-        return 6.6;
-      #else
-      return 0.65;
-      #endif
+        DFG.Succs[Source].push_back(i);
+        DFG.NumEdges++;
+        if (Source == i)
+          DFG.SelfEdge[i] = true;
+      }
     }
+  }
 
-    case Instruction::And:
-      // #ifdef OLD_SETUP
-      //   return 8.862;
-      // #endif
-      #ifdef SYS_AWARE
-        return 4.3;
-      #else
-      return 0.02;
-      #endif
-
-    case Instruction::Or:
-      // #ifdef OLD_SETUP
-      //   return 8.862;
-      // #endif
-      #ifdef SYS_AWARE
-        return 4.3;
-      #else
-      return 0.03;
-      #endif
+ // Compute the Critical Path of HW for Delay inside the BB of a Region or Function in nSecs.
+  //
+  // Longest path over the DFG, visiting the Nodes bottom-up in reverse program
+  // order. Paths through a cycle (a PHI fed by itself) are not followed.
+  //
+  float getDelayOfBB(BasicBlock *BB) {
 
-    case Instruction::Xor:
-      // #ifdef OLD_SETUP
-      //   return 8.862;
-      // #endif
-      #ifdef SYS_AWARE
-        return 4.3;
-      #else
-      return 0.03;
-      #endif
-
-    case Instruction::Select: // Same as Phi.
-      // #ifdef OLD_SETUP
-      //   return 5.299;
-      // #endif
-      #ifdef SYS_AWARE
-        return 4.3;
-      #else
-      return 0.23;
-      #endif
-
-    case Instruction::ICmp: // Check type of ICmp. (Equality or Relational) 
-    {
-      ICmpInst *Icmp = dyn_cast<ICmpInst>(&*Inst);
-
-      if (Icmp->isEquality())
-        // #ifdef OLD_SETUP
-        //   return 9.276;
-        // #endif
-        #ifdef SYS_AWARE
-          return 5;
-        #else
-        return 0.15;
-        #endif
-      else
-        // #ifdef OLD_SETUP
-        //   return 9.389;
-        // #endif
-       //#ifdef SYS_AWARE
-      //    return 4.8;
-       return 0;
-        //#else
-        //  return 0.37;
-        //#endif      
-    }
+    float DelayOfBB = 0;
+    BBDataFlowGraph DFG;
 
-    case Instruction::FCmp: // This is my estimation!
-      // #ifdef OLD_SETUP
-      //   return 9.276;
-      // #endif
-      #ifdef SYS_AWARE
-        return 5;
-      #else
-      return 0.15;
-      #endif
-
-    case Instruction::ZExt:
-      return 0;
+    getDataFlowGraphOfBB(BB, DFG);
 
-    case Instruction::SExt:
-      return 0;
+    if (DFG.NumEdges > 0) {
 
-    case Instruction::FPToUI:
-      return 0;
+      unsigned NumNodes = DFG.Nodes.size();
+      std::vector<float> DelayPaths(NumNodes);
+      std::vector<bool> InCycle(NumNodes);
 
-    case Instruction::FPToSI:
-      return 0;
+      // Critical Path Estimation. 
+      //
+      for (int i = NumNodes-1; i >= 0; i--) {
 
-    case Instruction::FPExt:
-      return 0;
+        float DelayNode = getDelayEstim(DFG.Nodes[i]);
 
-    case Instruction::PtrToInt:
-      return 0;
+        DelayPaths[i] = DelayNode;
+        InCycle[i] = DFG.SelfEdge[i];
 
-    case Instruction::IntToPtr:
-      return 0;
+        for (unsigned s = 0; s < DFG.Succs[i].size(); s++) {
+          unsigned Succ = DFG.Succs[i][s];
 
-    case Instruction::SIToFP:
-      return 0;
+          if (InCycle[Succ]) {
+            InCycle[i] = true;
+            continue;
+          }
+          DelayPaths[i] = std::max(DelayPaths[i], DelayNode + DelayPaths[Succ]);
+        }
+      }
 
-    case Instruction::UIToFP:
-      return 0;
+      DelayOfBB = get_max(DelayPaths); // Get the maximum Value of Delay within a BB.
+    }
 
-    case Instruction::Trunc:
-      return 0;
+    else
+      for (unsigned i = 0; i < DFG.Nodes.size(); i++)
+        DelayOfBB += getDelayEstim(DFG.Nodes[i]);
 
-    case Instruction::FPTrunc:
-      return 0;
+   #ifdef LOAD_AND_STORE_IN_DELAY_Of_BB   
+     // Get Loads and Stores in the BB.   
+     int LoadsAndStores   = getNumberofLoadsandStores(BB);
+     float LoadStoreDelay = LoadsAndStores * 10;
 
-    case Instruction::BitCast:
-      return 0;
+     //errs() << " Loads/Stores :  " << LoadsAndStores << "\n";
+     
+     // Compare Memory to Computation Delay
+     if (LoadStoreDelay > DelayOfBB)
+      DelayOfBB = LoadStoreDelay;
+  #endif
 
-    default:  // Assume default as 0 LUTs in Area estimation.
-      return 0;
+    //errs() << " Delay Estimation for BB is : " << format("%.8f", DelayOfBB) << "\n";
 
-    }// end of switch.
+    return DelayOfBB;
   }
 
-  //Area Estimation for each DFG Node/Istruction in LUTs
-// RegionSeeker  
-unsigned int getAreaEstim(Instruction *Inst)
-  {
+#ifdef SW_COST_TTI
+  // TargetTransformInfo cost of I, 0 where the host has none. It is an
+  // InstructionCost since LLVM 12, invalid for what the host can not lower.
+  //
+  long int getHostCostOfInst(Instruction *I, const TargetTransformInfo &TTI,
+                             TargetTransformInfo::TargetCostKind CostKind) {
+
+  #if LLVM_VERSION_MAJOR >= 12
+    InstructionCost Cost = TTI.getInstructionCost(I, CostKind);
+    return Cost.isValid() ? std::max<long int>(*Cost.getValue(), 0) : 0;
+  #else
+    return std::max(TTI.getInstructionCost(I, CostKind), 0);
+  #endif
+  }
 
-    switch (Inst->getOpcode()) {
+  // SW Cost in Cycles of BB on the host, from the TargetTransformInfo costs
+  // of its instructions. An out of order core is bound either by the
+  // latency of the critical path or by the reciprocal throughputs of all
+  // the instructions issued back to back - the longer of the two.
+  //
+  long int getHostSWCostOfBB(BasicBlock *BB, const TargetTransformInfo &TTI) {
 
-    case Instruction::GetElementPtr: 
-      return 0;
+    BBDataFlowGraph DFG;
+    getDataFlowGraphOfBB(BB, DFG);
 
-    case Instruction::Br:
-      return 0;
+    unsigned NumNodes = DFG.Nodes.size();
+    std::vector<long int> Ready(NumNodes, 0);
+    long int CriticalPath = 0, Throughput = 0;
 
-    case Instruction::Alloca:
-      return 0;
+    for (unsigned i = 0; i < NumNodes; i++) {
 
-    case Instruction::PHI:
-      #ifdef SYS_AWARE
-        return 16;
-      #else
-        return 33;
-      #endif
+      long int Latency    = getHostCostOfInst(DFG.Nodes[i], TTI, TargetTransformInfo::TCK_Latency);
+      long int RecipThrpt = getHostCostOfInst(DFG.Nodes[i], TTI, TargetTransformInfo::TCK_RecipThroughput);
 
-    case Instruction::Store:
-      return 0;
+      long int Done = Ready[i] + Latency;
+      CriticalPath  = std::max(CriticalPath, Done);
+      Throughput   += RecipThrpt;
 
-    case Instruction::Load:
-      return 0;
+      for (unsigned s = 0; s < DFG.Succs[i].size(); s++)
+        if (DFG.Succs[i][s] > i)
+          Ready[DFG.Succs[i][s]] = std::max(Ready[DFG.Succs[i][s]], Done);
+    }
 
-    case Instruction::Call:
-      return 0;
+    return std::max(CriticalPath, Throughput);
+  }
+#endif
 
-    case Instruction::Fence:
-      return 0;
+  // Starts of the chained BBs (see getChainedStartOfBB), for a single clock
+  // period.
+  //
+  typedef DenseMap<BasicBlock *, float> ChainedStartMap;
+
+#ifdef OPERATION_CHAINING
+  // Time in nSecs the operations of BB are done, chained into clock periods
+  // of NSecsPerCycle from Start on. An operation starts as soon as its
+  // operands are ready, in the same period when it still fits in it, or
+  // else at the next period. Operations longer than a period take whole
+  // periods. As in getDelayOfBB, a BB without data flow runs its operations
+  // one after the other.
+  //
+  float getChainedEndOfBB(BasicBlock *BB, float NSecsPerCycle, float Start) {
 
-    case Instruction::LandingPad:
-      return 0;
+    BBDataFlowGraph DFG;
+    getDataFlowGraphOfBB(BB, DFG);
 
-    case Instruction::AtomicCmpXchg:
-      return 0;
+    unsigned NumNodes = DFG.Nodes.size();
+    std::vector<float> Ready(NumNodes, Start);
+    float End = Start;
 
-    case Instruction::AtomicRMW: 
-      return 0;
+    for (unsigned i = 0; i < NumNodes; i++) {
 
-    case Instruction::ExtractValue: 
-      return 0;
+      float DelayNode = getDelayEstim(DFG.Nodes[i]);
+      float Period    = floor(Ready[i] / NSecsPerCycle) * NSecsPerCycle;
+      float Done      = Ready[i];
 
-    case Instruction::InsertValue:
-      return 0;
+      if (DelayNode > NSecsPerCycle)
+        Done = (Ready[i] > Period ? Period + NSecsPerCycle : Period) + ceil(DelayNode / NSecsPerCycle) * NSecsPerCycle;
+      else if (DelayNode > 0)
+        Done = (Ready[i] + DelayNode > Period + NSecsPerCycle ? Period + NSecsPerCycle : Ready[i]) + DelayNode;
 
-    case Instruction::Switch: // 33 * N (Number of Cases)
-    {
+      End = std::max(End, Done);
 
-      SwitchInst *Switch = dyn_cast<SwitchInst>(&*Inst);
-      //errs() << " Number of switches is  " << Switch->getNumCases() << "\t";
-      unsigned int NumCases = Switch->getNumCases();
-      #ifdef SYS_AWARE
-        return 16 * NumCases;
-      #else
+      if (DFG.NumEdges == 0 && i + 1 < NumNodes)
+        Ready[i + 1] = Done;
 
-        return 33 * NumCases;
-      #endif
+      for (unsigned s = 0; s < DFG.Succs[i].size(); s++)
+        if (DFG.Succs[i][s] > i)
+          Ready[DFG.Succs[i][s]] = std::max(Ready[DFG.Succs[i][s]], Done);
     }
-      
-    case Instruction::IndirectBr: 
-      return 0;
 
-    case Instruction::Invoke: 
-      return 0;
+    return End;
+  }
 
-    case Instruction::Resume: 
-      return 0;
+  // Time into its last period the BB before BB ends, when BB chains on from
+  // it: BB is its only successor and it is the only predecessor of BB. 0 when
+  // BB starts on a period of its own. The chain is walked up to its first BB
+  // or to a BB of Chained_Starts, then down again, keeping the start of every
+  // BB on the way in Chained_Starts. The BBs of a chain that closes on itself
+  // (dead code) all start on a period of their own.
+  //
+  float getChainedStartOfBB(BasicBlock *BB, float NSecsPerCycle, ChainedStartMap &Chained_Starts) {
 
-    case Instruction::Unreachable: 
-      return 0;
+    ChainedStartMap::iterator It = Chained_Starts.find(BB);
+    if (It != Chained_Starts.end())
+      return It->second;
 
-    case Instruction::Ret:
-      return 0;
+    SmallVector<BasicBlock *, 8> Chain; // BB, then the BBs before it.
+    SmallPtrSet<BasicBlock *, 8> Visited;
+    float Start = 0;
+    bool Cycle = false;
 
-    case Instruction::ShuffleVector:
-      return 0;
+    for (BasicBlock *Cur = BB; ; ) {
 
-    case Instruction::ExtractElement:
-      return 0;
+      Chain.push_back(Cur);
+      Visited.insert(Cur);
 
-    case Instruction::InsertElement:
-      return 0;
+      BasicBlock *Pred = Cur->getSinglePredecessor();
+      if (!Pred || Pred->getSingleSuccessor() != Cur)
+        break;
 
-    case Instruction::Add:
-      #ifdef SYS_AWARE
-        return 32;
-      #else
-        return 33;
-      #endif
+      if (Visited.count(Pred)) {
+        Cycle = true;
+        break;
+      }
 
-    case Instruction::FAdd:
-      #ifdef SYS_AWARE
-        return 32;
-      #else
-        return 33;
-      #endif
+      It = Chained_Starts.find(Pred);
+      if (It != Chained_Starts.end()) {
+        float End = getChainedEndOfBB(Pred, NSecsPerCycle, It->second);
+        Start = End - floor(End / NSecsPerCycle) * NSecsPerCycle;
+        break;
+      }
 
-    case Instruction::Sub:
-      #ifdef SYS_AWARE
-        return 32;
-      #else
-        return 33;
-      #endif
+      Cur = Pred;
+    }
 
-    case Instruction::FSub:
-      #ifdef SYS_AWARE
-        return 32;
-      #else
-        return 33;
-      #endif
+    for (unsigned i = Chain.size(); i-- > 0; ) {
 
-    case Instruction::Mul:
-      #ifdef SYS_AWARE
-        //return 267;
-     errs() << "Mul" << "\n";
-        return 0;
-      #else
-        return 618;
-      #endif
-      
-    case Instruction::FMul:
-      #ifdef SYS_AWARE
-        //return 267;
-     errs() << "FMul" << "\n";
-        return 0;
-      #else
-        return 618;
-      #endif
+      Chained_Starts[Chain[i]] = Start;
 
-    case Instruction::UDiv:
-      #ifdef SYS_AWARE
-       // return 1055;
-    errs() << "UDiv" << "\n";
-    return 320;
-      #else
-        return 1056;
-      #endif
+      if (i > 0 && !Cycle) {
+        float End = getChainedEndOfBB(Chain[i], NSecsPerCycle, Start);
+        Start = End - floor(End / NSecsPerCycle) * NSecsPerCycle;
+      }
+    }
 
-    case Instruction::SDiv:
-      #ifdef SYS_AWARE
-         // return 1214;
-    errs() << "SDiv" << "\n";
-    return 320;
-      #else
-        return 1185;
-      #endif
+    return Chained_Starts[BB];
+  }
 
-    case Instruction::FDiv:
-      #ifdef SYS_AWARE
-        // return 1214;
-    errs() << "FDiv" << "\n";
-    return 320;
-      #else
-        return 1185;
-      #endif
+  // HW Cycles of BB with chained operations. A period shared with the BB
+  // before is counted there.
+  //
+  double getChainedCyclesOfBB(BasicBlock *BB, float NSecsPerCycle, ChainedStartMap &Chained_Starts) {
 
-    case Instruction::URem:
-      #ifdef SYS_AWARE
-        // return 1122;
-     errs() << "URem" << "\n";
-     return 320;
-      #else
-        return 1312;
-      #endif
+    float Start = getChainedStartOfBB(BB, NSecsPerCycle, Chained_Starts);
+    float End   = getChainedEndOfBB(BB, NSecsPerCycle, Start);
 
-    case Instruction::SRem:
-      #ifdef SYS_AWARE
-       // return 1299;
-     errs() << "SRem" << "\n";
-     return 320;
-      #else
-        return 1312;
-      #endif
+    return std::max(0.0, ceil(End / NSecsPerCycle) - (Start > 0 ? 1 : 0));
+  }
+#endif
+
+#ifdef MEMORY_PORT_MODEL
+  // Ports of the arrays set in mem_ports.txt, keyed by "<Function> <Array>"
+  // (e.g. "@FIR_left_fxp_cloned %in"). Filled before any estimation.
+  StringMap<unsigned> Memory_Ports_Table;
+#endif
+
+#if defined(MEMORY_PORT_MODEL) || defined(LIST_SCHEDULING) || defined(LOOP_PIPELINING)
+  // Memory a Load/Store takes a port of, how many ports it has and the Cycles
+  // of an access. Without MEMORY_PORT_MODEL all of them share MEM_PORTS ports
+  // of a single memory, the latency left to getDelayEstim.
+  //
+  struct MemoryAccess {
+    Value *Object;
+    unsigned int Ports;
+    unsigned int Latency;
+  };
+
+  MemoryAccess getMemoryAccess(Instruction *Inst) {
+
+    MemoryAccess Access;
+
+#ifdef MEMORY_PORT_MODEL
+    // The array accessed - the address stripped of GEPs and casts. Local
+    // arrays and globals are BRAMs, the rest (pointer Arguments, pointers
+    // loaded from memory) is reached over M_AXI.
+    Value *Ptr = isa<LoadInst>(Inst) ? cast<LoadInst>(Inst)->getPointerOperand() : cast<StoreInst>(Inst)->getPointerOperand();
+    for (Ptr = Ptr->stripPointerCasts(); GEPOperator *GEP = dyn_cast<GEPOperator>(Ptr); )
+      Ptr = GEP->getPointerOperand()->stripPointerCasts();
+
+    bool Local = isa<AllocaInst>(Ptr) || isa<GlobalVariable>(Ptr);
+
+    Access.Object  = Ptr;
+    Access.Ports   = Local ? BRAM_PORTS : M_AXI_PORTS;
+    Access.Latency = Local ? BRAM_LATENCY : M_AXI_LATENCY;
+
+    StringMap<unsigned>::iterator It = Memory_Ports_Table.find(GetValueName(Inst->getFunction()) + " " + GetValueName(Ptr));
+    if (It != Memory_Ports_Table.end())
+      Access.Ports = std::max(1u, It->second);
+#else
+    (void) Inst; // A single memory.
+    Access.Object  = nullptr;
+    Access.Ports   = MEM_PORTS;
+    Access.Latency = 0;
+#endif
+
+    return Access;
+  }
 
-    case Instruction::FRem:
-      #ifdef SYS_AWARE
-        //return 1299;
-     errs() << "FRem" << "\n";
-        return 320;
-      #else
-        return 1312;
-      #endif
-
-    case Instruction::Shl:{
-
-      Value *Operand_two = Inst->getOperand(1);
-
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-
-      #ifdef SYS_AWARE
-        return 79;
-      #else
-        return 103;
-      #endif
-    
+  // Ports of each memory in use, by Cycle (by Cycle modulo II, when II > 0).
+  //
+  struct MemoryPortTable {
+    unsigned int II;
+    DenseMap<Value *, std::vector<unsigned> > Used;
+
+    MemoryPortTable(unsigned int II) : II(II) {}
+
+    unsigned &getUsed(Value *Object, unsigned Cycle) {
+      std::vector<unsigned> &Table = Used[Object];
+      unsigned Slot = II > 0 ? Cycle % II : Cycle;
+      if (Table.size() <= Slot)
+        Table.resize(II > 0 ? II : Slot + 1, 0);
+      return Table[Slot];
     }
-    
-    case Instruction::LShr: {
-      
-      Value *Operand_two = Inst->getOperand(1);
 
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-      
-         #ifdef SYS_AWARE
-        return 79;
-      #else
-        return 101;
-      #endif
+    bool isFree(const MemoryAccess &Access, unsigned Cycle) {
+      return getUsed(Access.Object, Cycle) < Access.Ports;
     }
 
-    case Instruction::AShr:{
-      
-      Value *Operand_two = Inst->getOperand(1);
-
-      if (Operand_two->getType()->isSingleValueType()) // Shift by a single value (e.g. integer)
-        return 0;
-      
-      #ifdef SYS_AWARE
-        return 99;
-      #else
-        return 145;
-      #endif
+    // Take a port at the first Cycle from Cycle on that has one free.
+    unsigned take(const MemoryAccess &Access, unsigned Cycle) {
+      while (!isFree(Access, Cycle))
+        Cycle++;
+      getUsed(Access.Object, Cycle)++;
+      return Cycle;
     }
 
-    case Instruction::And:
-      #ifdef SYS_AWARE
-        return 32;
-      #else
-        return 33;
-      #endif
-
-    case Instruction::Or:
-      #ifdef SYS_AWARE
-        return 32;
-      #else
-        return 33;
-      #endif
-
-    case Instruction::Xor:
-      #ifdef SYS_AWARE
-        return 32;
-      #else
-        return 33;
-      #endif
-
-    case Instruction::Select: // This is my estimation!
-      #ifdef SYS_AWARE
-        return 16;
-      #else
-        return 33;
-      #endif
-
-    case Instruction::ICmp: // Check type of ICmp. (Equality or Relational) 
-    {
-      ICmpInst *Icmp = dyn_cast<ICmpInst>(&*Inst);
-
-      if (Icmp->isEquality())
-        #ifdef SYS_AWARE
-          return 11;
-        #else
-          return 12;
-        #endif
-      else
-        #ifdef SYS_AWARE
-          return 16;
-        #else
-          return 17;
-        #endif      
+    // Ports in use at once, summed over the memories.
+    unsigned getBoundPorts() {
+      unsigned Ports = 0;
+      for (DenseMap<Value *, std::vector<unsigned> >::iterator It = Used.begin(); It != Used.end(); ++It)
+        Ports += *std::max_element(It->second.begin(), It->second.end());
+      return Ports;
     }
+  };
+#endif
+
+#ifdef MEMORY_PORT_MODEL
+  // Delay of BB in nSecs, as getDelayOfBB but with its Loads and Stores on the
+  // ports of their memories: an access starts on a Cycle boundary with a free
+  // port and takes the latency of the memory. Forward, in program order, over
+  // the paths getDelayOfBB follows - none into a cycle, and the Nodes one
+  // after the other in a BB without data flow.
+  //
+  float getMemoryDelayOfBB(BasicBlock *BB) {
 
-    case Instruction::FCmp: // This is my estimation!
-      #ifdef SYS_AWARE
-        return 16;
-      #else
-        return 17;
-      #endif 
-
-    case Instruction::ZExt:
-      return 0;
-
-    case Instruction::SExt:
-      return 0;
-
-    case Instruction::FPToUI:
-      return 0;
-
-    case Instruction::FPToSI:
-      return 0;
-
-    case Instruction::FPExt:
-      return 0;
-
-    case Instruction::PtrToInt:
-      return 0;
-
-    case Instruction::IntToPtr:
-      return 0;
-
-    case Instruction::SIToFP:
-      return 0;
+    float DelayOfBB = 0;
+    BBDataFlowGraph DFG;
+    MemoryPortTable Ports(0);
 
-    case Instruction::UIToFP:
-      return 0;
+    getDataFlowGraphOfBB(BB, DFG);
 
-    case Instruction::Trunc:
-      return 0;
+    unsigned NumNodes = DFG.Nodes.size();
+    std::vector<float> Start(NumNodes, 0);
+    std::vector<bool> InCycle(NumNodes);
 
-    case Instruction::FPTrunc:
-      return 0;
+    // Nodes on a path into a cycle, bottom-up as in getDelayOfBB.
+    for (int i = NumNodes-1; i >= 0; i--) {
+      InCycle[i] = DFG.SelfEdge[i];
+      for (unsigned s = 0; s < DFG.Succs[i].size(); s++)
+        if (InCycle[DFG.Succs[i][s]])
+          InCycle[i] = true;
+    }
 
-    case Instruction::BitCast:
-      return 0;
+    for (unsigned i = 0; i < NumNodes; i++) {
 
-    default:  // Assume default as 0 LUTs in Area estimation.
-      return 0;
+      Instruction *Inst = DFG.Nodes[i];
+      float DelayNode = getDelayEstim(Inst);
 
-    }// end of switch.
-  }
+      if (isa<LoadInst>(Inst) || isa<StoreInst>(Inst)) {
+        MemoryAccess Access = getMemoryAccess(Inst);
+        Start[i]  = Ports.take(Access, ceil(Start[i] / Target.NSecsPerCycle)) * Target.NSecsPerCycle;
+        DelayNode = Access.Latency * Target.NSecsPerCycle;
+      }
 
-    // Get Area Estimation for a Block iterator of a Function.
-  unsigned int getAreaOfBBInFunction(Function::iterator &BB) {
+      float Done = Start[i] + DelayNode;
+      DelayOfBB = std::max(DelayOfBB, Done);
 
-    unsigned int AreaOfBB = 0;
+      if (DFG.NumEdges == 0 && i + 1 < NumNodes)
+        Start[i + 1] = Done;
 
-    // Iterate inside the basic block.
-    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
-      AreaOfBB += getAreaEstim(&*BI);
+      for (unsigned s = 0; s < DFG.Succs[i].size(); s++) {
+        unsigned Succ = DFG.Succs[i][s];
+        if (Succ > i && !InCycle[Succ])
+          Start[Succ] = std::max(Start[Succ], Done);
+      }
+    }
 
-    return AreaOfBB;
+    return DelayOfBB;
   }
+#endif
 
-  // Get the Area extimation of a Function in LUTs.
+#ifdef LIST_SCHEDULING
+  // Functional Units a list schedule shares among the Instructions of a BB.
+  // Every other Instruction gets its own HW.
   //
-  unsigned int getAreaofFunction(Function *F){
+  enum FUClass { FU_ADD = 0, FU_MUL, FU_DIV, FU_MEM, NUM_FU_CLASSES, FU_UNLIMITED = NUM_FU_CLASSES };
 
-    unsigned int AreaofFunction = 0;
+  const unsigned int FU_Limit[NUM_FU_CLASSES] = { FU_ADDERS, FU_MULTIPLIERS, FU_DIVIDERS, MEM_PORTS };
 
-    for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
-      //AreaofFunction += getAreaOfBBInUMSq(&*BB);
-      AreaofFunction += getAreaOfBBInFunction(BB);
+  unsigned int getFUClass(Instruction *Inst) {
 
-    return AreaofFunction;
-  }
+    switch (Inst->getOpcode()) {
 
-    // SW Cost in Cycles estimation for a single BB. (Without Frequency of each BB)
-  //
-  long int getSWCostOfBB(BasicBlock *BB) {
+    case Instruction::Add:
+    case Instruction::FAdd:
+    case Instruction::Sub:
+    case Instruction::FSub:
+    case Instruction::ICmp:
+    case Instruction::FCmp:
+      return FU_ADD;
 
-    long int SWCostBB = 0;
+    case Instruction::Mul:
+    case Instruction::FMul:
+      return FU_MUL;
 
-    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
-      SWCostBB += getCycleSWDelayEstim(&*BI);
+    case Instruction::UDiv:
+    case Instruction::SDiv:
+    case Instruction::FDiv:
+    case Instruction::URem:
+    case Instruction::SRem:
+    case Instruction::FRem:
+      return FU_DIV;
 
+    case Instruction::Load:
+    case Instruction::Store:
+      return FU_MEM;
 
-    return SWCostBB;
+    default:
+      return FU_UNLIMITED;
+    }
   }
 
-
- // Compute the Critical Path of HW for Delay inside the BB of a Region or Function in nSecs.
+  // List Schedule of a BB: Latency in Cycles and the FUs of each class it
+  // binds (the most used at once).
   //
+  struct ListSchedule {
+    unsigned int Latency;
+    unsigned int FUs[NUM_FU_CLASSES];
+    unsigned int Area;   // LUTs, the Instructions of an FU class sharing FUs[class] of them.
+    unsigned int DSP;    // DSPs, shared the same way.
+  };
+
+  // Schedule the DFG of BB Cycle by Cycle on FU_Limit FUs per class, the ready
+  // Instructions with the longest path to the end of the BB first.
   //
-  float getDelayOfBB(BasicBlock *BB) {
-
-    float DelayOfBB = 0;
-    std::vector<Instruction *> worklist, send_node, receive_node;
-    std::vector<float> DelayPaths, DelayNodes;
+  // An Instruction with a Delay takes ceil(Delay / Cycle) Cycles
+  // (Loads and Stores at least one Cycle on a port of their memory), the
+  // others are wires and take none. Dividers are busy until they finish, the
+  // other FUs take a new Instruction every Cycle.
+  //
+  ListSchedule getListScheduleOfBB(BasicBlock *BB) {
+
+    ListSchedule Schedule;
+    BBDataFlowGraph DFG;
+
+    getDataFlowGraphOfBB(BB, DFG);
+
+    unsigned NumNodes = DFG.Nodes.size();
+    std::vector<unsigned> Latency(NumNodes), Class(NumNodes), Priority(NumNodes);
+    std::vector<unsigned> Waiting(NumNodes, 0), Earliest(NumNodes, 0);
+    std::vector<MemoryAccess> Access(NumNodes);
+    unsigned int Largest_FU_Area[NUM_FU_CLASSES] = {0}, Largest_FU_DSP[NUM_FU_CLASSES] = {0};
+
+    Schedule.Area = 0;
+    Schedule.DSP  = 0;
+    for (unsigned c = 0; c < NUM_FU_CLASSES; c++)
+      Schedule.FUs[c] = 0;
+
+    for (unsigned i = 0; i < NumNodes; i++) {
+      Class[i]   = getFUClass(DFG.Nodes[i]);
+      Latency[i] = ceil(getDelayEstim(DFG.Nodes[i]) / Target.NSecsPerCycle);
+      if (Class[i] == FU_MEM) {
+        Access[i]  = getMemoryAccess(DFG.Nodes[i]);
+        Latency[i] = Access[i].Latency;
+      }
+      if (Class[i] != FU_UNLIMITED)
+        Latency[i] = std::max(1u, Latency[i]);
 
-    worklist.clear();
-    send_node.clear();
-    receive_node.clear();
-    DelayPaths.clear();
-    DelayNodes.clear();
+      for (unsigned s = 0; s < DFG.Succs[i].size(); s++)
+        if (DFG.Succs[i][s] != i)
+          Waiting[DFG.Succs[i][s]]++;
+    }
 
-    // Iterate inside the basic block and gather all DFG Nodes.
-    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
-      worklist.push_back(&*BI);
-      DelayPaths.push_back(getDelayEstim(&*BI)); //Initialize the Delay Estimation for each DFG Node.
-      DelayNodes.push_back(getDelayEstim(&*BI)); //Initialize the Delay Estimation for each DFG Node.
+    // Longest path (Cycles) from each Instruction to the end of the BB.
+    for (int i = NumNodes-1; i >= 0; i--) {
+      Priority[i] = Latency[i];
+      for (unsigned s = 0; s < DFG.Succs[i].size(); s++)
+        if (DFG.Succs[i][s] != (unsigned) i)
+          Priority[i] = std::max(Priority[i], Latency[i] + Priority[DFG.Succs[i][s]]);
     }
-    
-    // Find Relation among DFG Nodes.
-    //
-    // Send_Node --> Receive_Node
-    //
-    for (std::vector<Instruction *>::iterator iter = worklist.begin(); iter != worklist.end(); ++iter) {
 
-      if(Instruction *Inst = *iter) {
+    std::vector<unsigned> Ready;
+    std::vector<std::vector<unsigned> > Busy(NUM_FU_CLASSES); // FUs in use, by Cycle.
+    MemoryPortTable Ports(0);
 
-        // Iterate over each operand of each Instruction.
-        for (unsigned int i=0; i<Inst->getNumOperands(); i++) {
+    for (unsigned i = 0; i < NumNodes; i++)
+      if (Waiting[i] == 0)
+        Ready.push_back(i);
 
-          Value *Operand = Inst->getOperand(i);
+    Schedule.Latency = 0;
+    for (unsigned int Cycle = 0, Scheduled = 0; Scheduled < NumNodes; Cycle++) {
 
-          if (PHINode *phi = dyn_cast<PHINode>(&*Inst) )
-            if (phi->getIncomingBlock(i) != BB)
-              continue;
+      // Wires finishing in this Cycle make their users ready in it too.
+      for (bool Progress = true; Progress; ) {
+        Progress = false;
 
-          int count =0;  
-          // Iterate over all the instructions of the Region and compare the operand to them.
-          for (std::vector<Instruction *>::iterator instruction_iterator = worklist.begin(); instruction_iterator != worklist.end(); ++instruction_iterator, count++) {
+        std::stable_sort(Ready.begin(), Ready.end(), [&Priority](unsigned A, unsigned B) {
+            return Priority[A] > Priority[B];
+          });
 
-            if(count <= find_inst(worklist, Inst) ) { // Might need to remove "=""
+        for (unsigned r = 0; r < Ready.size(); ) {
+          unsigned i = Ready[r];
+          unsigned Occupancy = Class[i] == FU_DIV ? Latency[i] : 1;
 
-              if(Instruction * Inst_source = *instruction_iterator) {
-                if (Operand == Inst_source) {
+          if (Earliest[i] > Cycle) {
+            r++;
+            continue;
+          }
 
-                  send_node.push_back(Inst_source); // Populate send_node vector
-                  receive_node.push_back(Inst); // Populate receive_node vector
-                }
-              }
+          if (Class[i] == FU_MEM) {
+            if (!Ports.isFree(Access[i], Cycle)) {
+              r++;
+              continue;
             }
+            Ports.take(Access[i], Cycle);
           }
+          else if (Class[i] != FU_UNLIMITED) {
+            std::vector<unsigned> &Used = Busy[Class[i]];
+            if (Used.size() < Cycle + Occupancy)
+              Used.resize(Cycle + Occupancy, 0);
+
+            bool Free = true;
+            for (unsigned c = Cycle; c < Cycle + Occupancy; c++)
+              Free = Free && Used[c] < FU_Limit[Class[i]];
+            if (!Free) {
+              r++;
+              continue;
+            }
+
+            for (unsigned c = Cycle; c < Cycle + Occupancy; c++)
+              Schedule.FUs[Class[i]] = std::max(Schedule.FUs[Class[i]], ++Used[c]);
+          }
+
+          unsigned Finish = Cycle + Latency[i];
+          Schedule.Latency = std::max(Schedule.Latency, Finish);
+
+          for (unsigned s = 0; s < DFG.Succs[i].size(); s++) {
+            unsigned Succ = DFG.Succs[i][s];
+            if (Succ == i)
+              continue;
+            Earliest[Succ] = std::max(Earliest[Succ], Finish);
+            if (--Waiting[Succ] == 0)
+              Ready.push_back(Succ);
+          }
+
+          Ready.erase(Ready.begin() + r);
+          Scheduled++;
+          Progress = true;
         }
       }
     }
 
+    Schedule.FUs[FU_MEM] = Ports.getBoundPorts();
 
-      // for (int i=0; i< send_node.size(); i++)
-      //   errs() << " sending Nodes " << *send_node[i] << "\n"; // My debugging Info!
-           
-      //      for (int i=0; i< receive_node.size(); i++)
-      //         errs() << " REceiving Nodes " << *receive_node[i] << "\n"; // My debugging Info!
+    // Area - the Instructions of a class share the bound FUs, each as large
+    // as the largest Instruction of the class.
+    for (unsigned i = 0; i < NumNodes; i++) {
+      unsigned int AreaInst = getAreaEstim(DFG.Nodes[i]);
+      unsigned int DSPInst  = getDSPEstim(DFG.Nodes[i]);
+      if (Class[i] == FU_UNLIMITED) {
+        Schedule.Area += AreaInst;
+        Schedule.DSP  += DSPInst;
+      }
+      else {
+        Largest_FU_Area[Class[i]] = std::max(Largest_FU_Area[Class[i]], AreaInst);
+        Largest_FU_DSP[Class[i]]  = std::max(Largest_FU_DSP[Class[i]], DSPInst);
+      }
+    }
+    for (unsigned c = 0; c < NUM_FU_CLASSES; c++) {
+      Schedule.Area += Schedule.FUs[c] * Largest_FU_Area[c];
+      Schedule.DSP  += Schedule.FUs[c] * Largest_FU_DSP[c];
+    }
 
-      // errs() << "\n\n"  ;
+    return Schedule;
+  }
+#endif
 
-      // for (int i=0; i< send_node.size(); i++) {
+  // Costs of a single BB (Without Frequency of each BB), shared by all the
+  // HW, SW and Area estimators.
+  //
+  struct BBCost {
+    float Delay;          // Critical Path in nSecs.
+    double HWCycles;      // Critical Path in Cycles.
+    unsigned int Area;    // LUTs.
+    long int SWCost;      // Cycles.
+    AreaVector Resources; // LUTs (the Area above), FFs, DSPs, BRAMs.
+#ifdef LIST_SCHEDULING
+    unsigned int FUs[NUM_FU_CLASSES]; // Bound by the list schedule.
+#endif
+  };
+
+  // Chained_Starts is only read and filled with OPERATION_CHAINING.
+  //
+  BBCost getCostOfBB(BasicBlock *BB, ChainedStartMap &Chained_Starts) {
+
+    BBCost Cost;
+    Function::iterator BBIter(BB);
+
+#ifdef MEMORY_PORT_MODEL
+    Cost.Delay    = getMemoryDelayOfBB(BB);
+#else
+    Cost.Delay    = getDelayOfBB(BB);
+#endif
+#ifdef OPERATION_CHAINING
+    Cost.HWCycles = getChainedCyclesOfBB(BB, Target.NSecsPerCycle, Chained_Starts);
+#else
+    (void) Chained_Starts; // Every BB starts on a period of its own.
+    Cost.HWCycles = ceil( Cost.Delay / Target.NSecsPerCycle );
+#endif
+    Cost.Area     = getAreaOfBBInFunction(BBIter);
+    Cost.SWCost   = getSWCostOfBB(BB);
+
+    Cost.Resources = AreaVector();
+    for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
+      Cost.Resources += getResourceEstim(&*BI);
 
-      //   errs() << " Edges " << *send_node[i] << "  --->     " <<  *receive_node[i] << "\n"; // My debugging Info!
+#ifdef LIST_SCHEDULING
+    ListSchedule Schedule = getListScheduleOfBB(BB);
 
+    Cost.HWCycles = Schedule.Latency;
+    Cost.Area     = Schedule.Area;
+    Cost.Resources.LUT = Schedule.Area;
+    Cost.Resources.DSP = Schedule.DSP;
+    for (unsigned c = 0; c < NUM_FU_CLASSES; c++)
+      Cost.FUs[c] = Schedule.FUs[c];
+#endif
 
-      // }
+    return Cost;
+  }
 
+#ifdef LOOP_PIPELINING
+  // Modulo Schedule of the body of a single-BB Loop, in Cycles.
+  //
+  struct ModuloSchedule {
+    unsigned int RecMII;  // Bound of the recurrences through the header PHIs.
+    unsigned int ResMII;  // Bound of the memory ports.
+    unsigned int II;      // Initiation Interval.
+    unsigned int Depth;   // Latency of one iteration.
+  };
+
+  // Schedule the DFG of BB - a Loop made of that single BB - as soon as
+  // possible, operations chained in nSecs as in getDelayOfBB. Loads and
+  // Stores start on a Cycle boundary and take a port of their memory for that
+  // Cycle modulo II (see getMemoryAccess). II starts at max(RecMII, ResMII) and grows until every
+  // recurrence (PHI <-- value of the previous iteration) fits in II Cycles.
+  //
+  ModuloSchedule getModuloScheduleOfBB(BasicBlock *BB) {
+
+    ModuloSchedule Schedule;
+    BBDataFlowGraph DFG;
+
+    getDataFlowGraphOfBB(BB, DFG);
+
+    unsigned NumNodes = DFG.Nodes.size();
+    std::vector<float> Delay(NumNodes);
+    std::vector<MemoryAccess> Access(NumNodes);
+    DenseMap<Value *, unsigned> Accesses; // Loads/Stores of each memory.
+    std::vector<std::pair<unsigned, unsigned> > Recurrences; // (PHI, Value)
+    DenseMap<Instruction *, unsigned> Index;
+
+    for (unsigned i = 0; i < NumNodes; i++) {
+      Index[DFG.Nodes[i]] = i;
+      Delay[i] = getDelayEstim(DFG.Nodes[i]);
+      if (isa<LoadInst>(DFG.Nodes[i]) || isa<StoreInst>(DFG.Nodes[i])) {
+        Access[i] = getMemoryAccess(DFG.Nodes[i]);
+        Delay[i]  = std::max(Delay[i], (float) Access[i].Latency * Target.NSecsPerCycle);
+        Accesses[Access[i].Object]++;
+      }
+    }
 
-    if (send_node.size() > 0 && receive_node.size() >0) {
+    for (unsigned i = 0; i < NumNodes; i++)
+      if (PHINode *Phi = dyn_cast<PHINode>(DFG.Nodes[i]))
+        if (Phi->getBasicBlockIndex(BB) >= 0)
+          if (Instruction *Value = dyn_cast<Instruction>(Phi->getIncomingValueForBlock(BB)))
+            if (Value->getParent() == BB)
+              Recurrences.push_back(std::make_pair(i, Index[Value]));
 
-      // Critical Path Estimation. 
-      //       
-      // 
-      for (std::vector<Instruction *>::iterator instr_iter = worklist.begin(); instr_iter != worklist.end(); ++instr_iter) {
+    Schedule.ResMII = 1;
+    for (unsigned i = 0; i < NumNodes; i++)
+      if (isa<LoadInst>(DFG.Nodes[i]) || isa<StoreInst>(DFG.Nodes[i]))
+        Schedule.ResMII = std::max(Schedule.ResMII, (Accesses[Access[i].Object] + Access[i].Ports - 1) / Access[i].Ports);
+    Schedule.RecMII = 1;
 
-        Instruction *instr_temp = *instr_iter;
+    // II = 0 schedules without the memory ports, for RecMII.
+    std::vector<float> Start(NumNodes);
+    for (unsigned int II = 0; ; II = (II == 0 ? std::max(Schedule.RecMII, Schedule.ResMII) : II + 1)) {
 
-        // Find the end Nodes (Bottom-most Nodes in the DFG Graph)
-        if (find_inst(send_node, instr_temp) == -1) {
+      MemoryPortTable Ports(II); // Modulo Reservation Table.
+      std::fill(Start.begin(), Start.end(), 0);
+      float Length = 0;
 
-          Instruction *EndNode = instr_temp;
-          std::vector<Instruction *> BottomNodes;
-          BottomNodes.clear();
-          BottomNodes.push_back(EndNode);
+      for (unsigned i = 0; i < NumNodes; i++) {
 
-          Instruction *CurrentNode;
-          int position =0;
+        if (II > 0 && (isa<LoadInst>(DFG.Nodes[i]) || isa<StoreInst>(DFG.Nodes[i])))
+          Start[i] = Ports.take(Access[i], ceil(Start[i] / Target.NSecsPerCycle)) * Target.NSecsPerCycle;
 
-          //float delay_path_estimation;
+        for (unsigned s = 0; s < DFG.Succs[i].size(); s++)
+          if (DFG.Succs[i][s] != i)
+            Start[DFG.Succs[i][s]] = std::max(Start[DFG.Succs[i][s]], Start[i] + Delay[i]);
 
-          while(BottomNodes.size() >0) {  
+        Length = std::max(Length, Start[i] + Delay[i]);
+      }
 
-            CurrentNode = BottomNodes[0];
+      // Cycles between the start of a PHI and its value for the next iteration.
+      unsigned int Recurrence = 1;
+      for (unsigned r = 0; r < Recurrences.size(); r++) {
+        float Distance = Start[Recurrences[r].second] + Delay[Recurrences[r].second] - Start[Recurrences[r].first];
+        Recurrence = std::max(Recurrence, (unsigned int) ceil(Distance / Target.NSecsPerCycle));
+      }
 
-            while (find_inst(receive_node, CurrentNode) >=0) {
+      Schedule.Depth = std::max(1.0, ceil(Length / Target.NSecsPerCycle));
 
-              position = find_inst(receive_node, CurrentNode); 
+      if (II == 0)
+        Schedule.RecMII = Recurrence;
+      else if (Recurrence <= II) {
+        Schedule.II = II;
+        break;
+      }
+    }
 
-              DelayPaths[find_inst(worklist, send_node[position])] = std::max( DelayPaths[find_inst(worklist, send_node[position])] , DelayNodes[find_inst(worklist, send_node[position])] +  DelayPaths[find_inst(worklist, CurrentNode)]  );
-              Instruction *Predecessor = send_node[position];
+    return Schedule;
+  }
+#endif
 
-              receive_node.erase(receive_node.begin() + position);   // deleting the last edge
-              send_node.erase(send_node.begin() + position);        //  deleting the last edge
+#ifdef LOOP_LEVEL_PARALLELISM
+  // A Loop carries a dependence through a header PHI that is neither an
+  // induction variable nor a reduction - the next iteration waits for it.
+  // Loops not in simplified form (no preheader or single latch) are assumed
+  // to carry one.
+  //
+  bool hasCarriedPHI(Loop *L, ScalarEvolution *SE) {
 
-              if (find_inst(send_node, Predecessor) == -1)
-                BottomNodes.push_back(Predecessor);
+    if (!L->getLoopPreheader() || !L->getLoopLatch())
+      return isa<PHINode>(L->getHeader()->begin());
 
-            }
+    for (BasicBlock::iterator I = L->getHeader()->begin(); PHINode *Phi = dyn_cast<PHINode>(&*I); ++I) {
+      InductionDescriptor Induction;
+      RecurrenceDescriptor Reduction;
 
-            BottomNodes.erase(BottomNodes.begin()); // Delete the First element of the BottomNodes list.
+      if (!InductionDescriptor::isInductionPHI(Phi, L, SE, Induction) &&
+          !RecurrenceDescriptor::isReductionPHI(Phi, L, Reduction))
+        return true;
+    }
+    return false;
+  }
 
-            
-          }
-        }
-      }
+  // A Loop carries a dependence through memory when two of its accesses (one
+  // of them a write) may touch the same location in different iterations, i.e.
+  // the direction at the depth of the Loop is not '='.
+  //
+  bool hasCarriedMemoryDependence(Loop *L, DependenceInfo *DI) {
 
-      DelayOfBB = get_max(DelayPaths); // Get the maximum Value of Delay within a BB.
-    }
+    std::vector<Instruction *> Memory_Accesses;
+    unsigned Depth = L->getLoopDepth();
 
-    else
-      for (unsigned i = 0; i < worklist.size(); i++)
-        DelayOfBB += getDelayEstim(worklist[i]);
+    for (Loop::block_iterator BB = L->block_begin(); BB != L->block_end(); ++BB)
+      for (BasicBlock::iterator I = (*BB)->begin(); I != (*BB)->end(); ++I)
+        if (I->mayReadOrWriteMemory())
+          Memory_Accesses.push_back(&*I);
 
-   #ifdef LOAD_AND_STORE_IN_DELAY_Of_BB   
-     // Get Loads and Stores in the BB.   
-     int LoadsAndStores   = getNumberofLoadsandStores(BB);
-     float LoadStoreDelay = LoadsAndStores * 10;
+    for (unsigned i = 0; i < Memory_Accesses.size(); i++)
+      for (unsigned j = i; j < Memory_Accesses.size(); j++) {
 
-     //errs() << " Loads/Stores :  " << LoadsAndStores << "\n";
-     
-     // Compare Memory to Computation Delay
-     if (LoadStoreDelay > DelayOfBB)
-      DelayOfBB = LoadStoreDelay;
-  #endif
+        if (!Memory_Accesses[i]->mayWriteToMemory() && !Memory_Accesses[j]->mayWriteToMemory())
+          continue;
 
-    //errs() << " Delay Estimation for BB is : " << format("%.8f", DelayOfBB) << "\n";
-      
-    // for (int i=0; i< DelayPaths.size(); i++)
-    //   errs() << " Delays " << format("%.8f", DelayPaths[i]) << "\n"; // My debugging Info!
+        std::unique_ptr<Dependence> Dep = DI->depends(Memory_Accesses[i], Memory_Accesses[j], true);
+        if (!Dep)
+          continue;
 
-    return DelayOfBB;
+        if (Dep->isConfused() || Dep->getLevels() < Depth ||
+            Dep->getDirection(Depth) != Dependence::DVEntry::EQ)
+          return true;
+      }
+    return false;
+  }
+
+  // Unroll Factor of a Loop when up to LUF copies of its body are wanted:
+  // 1 when iterations depend on each other, otherwise the largest factor up
+  // to LUF that divides the Trip Count (LUF itself when the Trip Count is
+  // not known at compile time).
+  //
+  unsigned int getUnrollFactor(unsigned int TripCount, bool Carried, unsigned int LUF) {
+
+    if (Carried)
+      return 1;
+    if (TripCount == 0)
+      return LUF;
+
+    for (unsigned int Factor = std::min(LUF, TripCount); Factor > 1; Factor--)
+      if (TripCount % Factor == 0)
+        return Factor;
+    return 1;
   }
+#endif
 
 }
@@ -0,0 +1,167 @@
+//===---------------------- AccelSeekerCommon.h ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+// 
+// This file is distributed under the Università della Svizzera italiana (USI) 
+// Open Source License.
+//
+// Author         : Georgios Zacharopoulos 
+// Date Started   : June, 2018
+//
+//===----------------------------------------------------------------------===//
+//
+// Function registry and call targets of the app, shared by the AccelSeeker
+// and AccelSeekerIO passes. Each pass defines its own isSystemCall.
+//
+//===----------------------------------------------------------------------===//
+
+#define MAX_INDIRECT_TARGETS     8         // Targets of an indirect call taken from its value profile.
+
+// Indexed profile (llvm-profdata merge) of the IR level instrumented app. It
+// annotates the Module in memory - entry counts, branch weights and value
+// profiles of indirect calls - so the same IR is estimated against any
+// profile, without the annotated IR of "make profile". One option for both
+// passes, so that both read the same profile.
+static cl::opt<std::string> ProfileFile("accelseeker-profile",
+  cl::desc("Indexed profile (.profdata) the Module is estimated against"), cl::init(""));
+
+namespace {
+
+static std::string GetValueName(const Value *V) {
+  if (V) {
+    std::string name;
+    raw_string_ostream namestream(name);
+    V->printAsOperand(namestream, false);
+    return namestream.str();
+  } else
+    return "[null]";
+}
+
+  // Registry of the app's Functions. Every Function keeps the index it was
+  // registered with, looked up by Function* or by name in O(1).
+  //
+  struct FunctionRegistry {
+    std::vector<Function *> Functions;   // By index.
+    DenseMap<Function *, unsigned> Index;
+    StringMap<unsigned> Name_Index;      // Keyed by GetValueName (e.g. "@foo").
+
+    // Register F (if not already) and return its index.
+    unsigned insert(Function *F) {
+
+      std::pair<DenseMap<Function *, unsigned>::iterator, bool> Entry =
+        Index.insert(std::make_pair(F, (unsigned) Functions.size()));
+
+      if (Entry.second) {
+        Functions.push_back(F);
+        Name_Index.insert(std::make_pair(GetValueName(F), Entry.first->second));
+      }
+      return Entry.first->second;
+    }
+
+    int find(Function *F) const {
+      DenseMap<Function *, unsigned>::const_iterator It = Index.find(F);
+      return It == Index.end() ? -1 : (int) It->second;
+    }
+
+    int find(StringRef Fun_name) const {
+      StringMap<unsigned>::const_iterator It = Name_Index.find(Fun_name);
+      return It == Name_Index.end() ? -1 : (int) It->second;
+    }
+
+    Function *operator[](unsigned i) const { return Functions[i]; }
+    unsigned size() const { return Functions.size(); }
+  };
+
+  // Check for System Calls or other than the application's functions.
+  // Defined by each pass.
+  //
+  bool isSystemCall(Function *F);
+
+  // Functions of the Module by the MD5 of their PGO name - the values the
+  // value profile of an indirect call records for its targets.
+  //
+  DenseMap<uint64_t, Function *> Profiled_Functions;
+
+  void indexProfiledFunctions(Module &M) {
+
+    Profiled_Functions.clear();
+    for (Module::iterator FI = M.begin(), FE = M.end(); FI != FE; ++FI)
+      Profiled_Functions[IndexedInstrProf::ComputeHash(getPGOFuncName(*FI))] = &*FI;
+  }
+
+  // Annotate M with the counts of -accelseeker-profile (if given). False if
+  // the profile file can not be read.
+  //
+  bool applyProfile(Module &M) {
+
+    if (ProfileFile.empty())
+      return true;
+
+    if (!std::ifstream(ProfileFile).good())
+      return false;
+
+    legacy::PassManager PGO;
+    PGO.add(createPGOInstrumentationUseLegacyPass(ProfileFile));
+    PGO.run(M);
+    return true;
+  }
+
+  // A Function a call reaches, with the share of the calls of the call site
+  // that reach it.
+  //
+  struct CallTarget {
+    Function *Calee;
+    double Share;
+  };
+
+  // Get the Functions (*not* System Calls) a Call reaches: the called
+  // Function, or the targets of an indirect call from its value profile
+  // (!prof VP), most called first. Unprofiled indirect calls reach none.
+  //
+  void getCallTargets(CallInst *Call, SmallVectorImpl<CallTarget> &Targets) {
+
+    if (Function *Calee = Call->getCalledFunction()) {
+      if (!isSystemCall(Calee))
+        Targets.push_back({Calee, 1.0});
+      return;
+    }
+
+    InstrProfValueData Value_Data[MAX_INDIRECT_TARGETS];
+    uint32_t Num_Targets;
+    uint64_t Total_Count;
+
+    if (!getValueProfDataFromInst(*Call, IPVK_IndirectCallTarget, MAX_INDIRECT_TARGETS,
+                                  Value_Data, Num_Targets, Total_Count) || !Total_Count)
+      return;
+
+    for (uint32_t i = 0; i < Num_Targets; i++) {
+      DenseMap<uint64_t, Function *>::iterator It = Profiled_Functions.find(Value_Data[i].Value);
+
+      if (It != Profiled_Functions.end() && !isSystemCall(It->second))
+        Targets.push_back({It->second, (double) Value_Data[i].Count / Total_Count});
+    }
+  }
+
+  // Get the Functions of the app (*not* System Calls) that F calls, in the
+  // order the calls appear. Indirect calls count with their profiled targets.
+
+  // Get the Functions of the app (*not* System Calls) that F calls, in the
+  // order the calls appear. Indirect calls count with their profiled targets.
+  // External Functions (declarations) only with With_Declarations.
+  //
+  void getCalledFunctions(Function *F, std::vector<Function *> &Callees,
+                          bool With_Declarations) {
+
+    for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+      for(BasicBlock::iterator BI = BB->begin(), BE = BB->end(); BI != BE; ++BI)
+        if(CallInst *Call = dyn_cast<CallInst>(BI)) {
+          SmallVector<CallTarget, 4> Targets;
+          getCallTargets(Call, Targets);
+
+          for (unsigned t = 0; t < Targets.size(); t++)
+            if (With_Declarations || !Targets[t].Calee->isDeclaration())
+              Callees.push_back(Targets[t].Calee);
+        }
+  }
+
+}
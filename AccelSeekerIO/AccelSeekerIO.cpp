@@ -17,6 +17,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/BasicBlock.h"
@@ -37,6 +41,10 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Transforms/Instrumentation.h"
 #include "llvm/Transforms/Utils/Local.h"
 #include <string>
 #include <iostream>
@@ -53,34 +61,63 @@ using namespace llvm;
 
 namespace {
 
-  struct AccelSeekerIO : public FunctionPass {
+  struct AccelSeekerIO : public ModulePass {
     static char ID; // Pass Identification, replacement for typeid
 
-    std::vector<Function *> Function_list; // Global Function List
-    std::vector<StringRef> Function_Names_list; // Global Function List Names
-    std::vector<Function *> Function_Local_list; //  Function List
+    FunctionRegistry Function_list; // Global Function List
+    SmallPtrSet<Function *, 16> Function_Local_list; //  Callees already walked for the current Function
 
+    TransitiveCallees Callees;      // Transitive Callees of each Function.
+    BitVector Registered_Reach;     // Functions whose Transitive Callees are all in Function_list.
 
-    AccelSeekerIO() : FunctionPass(ID) {}
+    std::string IO_buffer, FCI_buffer; // IO.txt and FCI.txt, written once at the end.
+
+
+    AccelSeekerIO() : ModulePass(ID) {}
 
     // Run on the whole app.
-    bool runOnFunction(Function &F){
- 
-     if (!isSystemCall(&F)){
-	     errs() << "\n\n Function Name : " << F.getName() << "\n";
+    //
+    // Functions are visited in Module order, as a FunctionPass would. The
+    // Transitive Callees (FCI indexes) of each Function come from bitsets
+    // computed once per SCC of the call graph.
+    //
+    bool runOnModule(Module &M){
 
-        errs() << "\n\n Initialize list with Funs : " << "\n";
-        initFunctionList(&F);
+      // Optional - value profiles of an indexed profile in place of the ones of the IR.
+      if (!applyProfile(M)) {
+        errs() << "error_profile_file" << "\n";
+        return 1;
+      }
 
-        for (unsigned int i=0; i< Function_list.size(); i++)
-          errs() << GetValueName(Function_list[i]) << "\n";
+      // Targets of the indirect calls, looked up by the values of their value profiles.
+      indexProfiledFunctions(M);
 
-        errs() << "\n\n Get the calls within Functions : " << "\n";
-        getAccelSeekerIO(&F);
+      getTransitiveCallees(M, Callees);
+      Registered_Reach.resize(Callees.Nodes.size());
 
-      
+      for (Module::iterator FI = M.begin(), FE = M.end(); FI != FE; ++FI) {
+        Function *F = &*FI;
+
+        if (F->isDeclaration() || isSystemCall(F))
+          continue;
+
+	errs() << "\n\n Function Name : " << F->getName() << "\n";
+
+        initFunctionList(F);
+
+        errs() << "\n\n Get the calls within Functions : " << "\n";
+        getAccelSeekerIO(F);
       }
-      return false;
+
+      IO_file.open ("IO.txt", std::ofstream::out | std::ofstream::app);
+      IO_file << IO_buffer;
+      IO_file.close();
+
+      myfile.open ("FCI.txt", std::ofstream::out | std::ofstream::app);
+      myfile << FCI_buffer;
+      myfile.close();
+
+      return !ProfileFile.empty(); // Only the profile metadata is changed.
     }
 
 
@@ -88,13 +125,8 @@ namespace {
     //
     bool initFunctionList(Function *F) {
 
-      if (find_function(Function_list, F) == -1 && isSystemCall(F) == false){
-
-        std::string Function_Name = GetValueName(F);
-
-        Function_list.push_back(F);
-        Function_Names_list.push_back(GetValueName(F));
-      }
+      if (Function_list.find(F) == -1 && isSystemCall(F) == false)
+        Function_list.insert(F);
 
       return true;
     }
@@ -114,9 +146,7 @@ namespace {
 
         long int InputData = getInputFunction(F);
 
-         IO_file.open ("IO.txt", std::ofstream::out | std::ofstream::app); 
-         IO_file << Function_Name << " " << InputData << "\n";
-         IO_file.close();
+         IO_buffer += Function_Name + " " + std::to_string(InputData) + "\n";
 
       
 
@@ -125,7 +155,7 @@ namespace {
       // 2
       //    
       Function_Local_list.clear();
-      int F_index = find_function(Function_list, F);
+      int F_index = Function_list.find(F);
 //    	 if (Function_Name != "@main" 
 //    	    && Function_Name != "@decode_main"  
 //	    && Function_Name != "@merged8"   
@@ -133,14 +163,21 @@ namespace {
 //	) {
  errs() << "Function Name " << Function_Name << "\n"; 
 
-          myfile.open ("FCI.txt", std::ofstream::out | std::ofstream::app); 
-          myfile << Function_Name << " " << F_index << " " ;
-          myfile.close();
-            getIndexesOfCalledFunctions(F);
+          registerCalledFunctions(F);
+
+          // All Transitive Callees of F are registered now.
+          const BitVector &Reach = Callees.get(F);
+          Registered_Reach |= Reach;
+          Registered_Reach.set(Callees.Node_Index[F]);
 
-          myfile.open ("FCI.txt", std::ofstream::out | std::ofstream::app); 
-          myfile << "\n";
-          myfile.close(); 
+          // In walk order, each index once - the Overlapping Rule pivots on the first ones.
+          std::vector<Function *> Walk_Order;
+          Callees.getInWalkOrder(F, Walk_Order);
+
+          FCI_buffer += Function_Name + " " + std::to_string(F_index) + " ";
+          for (unsigned int i = 0; i < Walk_Order.size(); i++)
+            FCI_buffer += std::to_string(Function_list.find(Walk_Order[i])) + " ";
+          FCI_buffer += "\n";
 //     	}
 //
 //
@@ -206,10 +243,10 @@ namespace {
 
        
                 //StringRef Indirect_Called_Name = SV->getName();
-                StringRef Indirect_Called_Name = GetValueName(SV);
+                std::string Indirect_Called_Name = GetValueName(SV);
                 //errs() <<"\t" << F->getName() << "\t -->\t" << Indirect_Called_Name << "\n";
 
-                int fun_index = find_function_name(Function_Names_list, Indirect_Called_Name);
+                int fun_index = Function_list.find(Indirect_Called_Name);
 
                 if (fun_index >=0) { // Is it in our list?
 
@@ -272,10 +309,13 @@ namespace {
     }
 
 
-    // Record the Indexes of the Function Calls within each Function.
+    // Register the Functions called within each Function, nested calls included.
     //
+    // Indexes are given in the order the calls are first met walking down
+    // from F. Functions whose Transitive Callees are all registered already
+    // are not walked again.
     //
-    void getIndexesOfCalledFunctions(Function *F) {
+    void registerCalledFunctions(Function *F) {
 
 
       for(Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
@@ -285,43 +325,29 @@ namespace {
          
           if(CallInst *Call = dyn_cast<CallInst>(BI)) {
 
-            
-            if (Call->getCalledFunction()) {
+            SmallVector<CallTarget, 4> Targets;
+            getCallTargets(Call, Targets); // Profiled targets of indirect calls as well.
 
-              if (!isSystemCall(Call->getCalledFunction())) {
+            for (unsigned t = 0; t < Targets.size(); t++) {
 
-                Function *Calee = Call->getCalledFunction();
+              Function *Calee = Targets[t].Calee;
 
-                int fun_index = find_function(Function_list, Calee);
-		int fun_index_local = find_function(Function_Local_list, Calee);
-		
+              int fun_index = Function_list.find(Calee);
 
-                if (fun_index >=0) {
-	 	    if (fun_index_local == -1) {
-		 	Function_Local_list.push_back(Calee);	
+              if (fun_index >=0) {
+	 	    if (Function_Local_list.insert(Calee).second) {
 		 	errs() <<  " Calee Name " << GetValueName(Calee) << "\n"; 
 
-                  	myfile.open ("FCI.txt", std::ofstream::out | std::ofstream::app); 
-                 	 myfile << fun_index <<" ";
-                  	myfile.close();
-		  	if (Calee !=F)
-                		getIndexesOfCalledFunctions(Calee);
+		  	if (Calee !=F && !Registered_Reach.test(Callees.Node_Index[Calee]))
+                		registerCalledFunctions(Calee);
                 	}
 		}
-                else{ // Not in the current list
-                  // Write a function or reorder this.
-
-                  Function_list.push_back(Calee);
-                  int fun_index_new = find_function(Function_list, Calee);
-                  
-                  myfile.open ("FCI.txt", std::ofstream::out | std::ofstream::app); 
-                  myfile << fun_index_new <<" ";
-                  myfile.close();
-                getIndexesOfCalledFunctions(Calee);
-
-                }
+              else{ // Not in the current list
 
+                Function_list.insert(Calee);
+                registerCalledFunctions(Calee);
               }
+
             }
           } // End of IF
         } // End of For - BB Iterator
@@ -395,11 +421,6 @@ namespace {
 
     virtual void getAnalysisUsage(AnalysisUsage& AU) const override {
               
-        AU.addRequired<LoopInfoWrapperPass>();
-        AU.addRequired<RegionInfoPass>();
-        AU.addRequiredTransitive<RegionInfoPass>();
-        AU.addRequiredTransitive<ScalarEvolutionWrapperPass>();
-        AU.addRequired<BlockFrequencyInfoWrapperPass>();
         AU.setPreservesAll();
     } 
   };
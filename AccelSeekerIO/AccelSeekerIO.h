@@ -22,41 +22,10 @@ using namespace llvm;
 std::ofstream IO_file; // File that I/O info is written.
 std::ofstream myfile; // File that I/O info is written.
 
+#include "../AccelSeeker/AccelSeekerCommon.h" // Shared with the AccelSeeker pass.
 
 namespace {
 
-static std::string GetValueName(const Value *V) {
-  if (V) {
-    std::string name;
-    raw_string_ostream namestream(name);
-    V->printAsOperand(namestream, false);
-    return namestream.str();
-  } else
-    return "[null]";
-}
-
-
-  int find_function(std::vector<Function *> list, Function *Fun) {
-
-    for (unsigned i = 0; i < list.size(); i++)
-      if (list[i] == Fun)
-        return i;
-      
-    
-    return -1;
-  }
-
-  int find_function_name(std::vector<StringRef> list, StringRef Fun_name) {
-
-    for (unsigned i = 0; i < list.size(); i++)
-      if (list[i] == Fun_name)
-        return i;
-      
-    
-    return -1;
-  }
-
-
   // Check for System Calls or other than the application's functions.
   //
   bool isSystemCall(Function *F)
@@ -281,6 +250,155 @@ static std::string GetValueName(const Value *V) {
 
   }
 
+  // Transitive Callees of every Function of the app, as bitsets.
+  // Bit i of a set stands for Nodes[i]. Members of an SCC share one set.
+  //
+  struct TransitiveCallees {
+    std::vector<Function *> Nodes;
+    DenseMap<Function *, unsigned> Node_Index;
+    DenseMap<Function *, unsigned> SCC_Index;
+    std::vector<BitVector> Reach; // Per SCC.
+    std::vector<std::vector<unsigned> > Calls; // Per Node, its Callees in call order.
+
+    const BitVector &get(Function *F) { return Reach[SCC_Index[F]]; }
+
+    // Transitive Callees of F in the order a walk down from F first meets
+    // them - each Callee walked on the first time it is met, F itself never.
+    // The order FCI rows are written in (the Overlapping Rule pivots on it).
+    //
+    void getInWalkOrder(Function *F, std::vector<Function *> &Order) {
+
+      unsigned Root = Node_Index[F], Reached = get(F).count();
+      BitVector Visited(Nodes.size());
+      std::vector<std::pair<unsigned, unsigned> > Walk; // Node, next Call.
+
+      Walk.push_back(std::make_pair(Root, 0));
+      while (!Walk.empty() && Order.size() < Reached) {
+
+        unsigned Node = Walk.back().first;
+        if (Walk.back().second == Calls[Node].size()) {
+          Walk.pop_back();
+          continue;
+        }
+
+        unsigned Calee = Calls[Node][Walk.back().second++];
+        if (Visited.test(Calee))
+          continue;
+
+        Visited.set(Calee);
+        Order.push_back(Nodes[Calee]);
+        if (Calee != Root)
+          Walk.push_back(std::make_pair(Calee, 0));
+      }
+    }
+  };
+
+  // Compute the Transitive Callees once per SCC of the call graph, bottom-up.
+  // The SCCs are found in post-order (Tarjan), so the sets of the callees
+  // outside the SCC are complete when an SCC is finished.
+  //
+  void getTransitiveCallees(Module &M, TransitiveCallees &TC) {
+
+    struct DFSFrame {
+      Function *F;
+      std::vector<Function *> Callees;
+      unsigned NextCallee;
+    };
+
+    DenseMap<Function *, unsigned> DFSIndex, LowLink;
+    DenseMap<Function *, bool> OnStack;
+    DenseMap<Function *, std::vector<Function *> > Callees_list;
+    std::vector<Function *> SCCStack;
+    std::vector<DFSFrame> DFSStack;
+    std::vector<std::vector<Function *> > SCCs;
+    unsigned NextIndex = 0;
+
+    auto pushFunction = [&](Function *F) {
+      DFSIndex[F] = LowLink[F] = NextIndex++;
+      SCCStack.push_back(F);
+      OnStack[F] = true;
+      DFSStack.push_back(DFSFrame{F, std::vector<Function *>(), 0});
+      getCalledFunctions(F, DFSStack.back().Callees, true);
+    };
+
+    for (Module::iterator FI = M.begin(), FE = M.end(); FI != FE; ++FI) {
+
+      Function *Root = &*FI;
+
+      if (isSystemCall(Root) || DFSIndex.count(Root))
+        continue;
+
+      pushFunction(Root);
+
+      while (!DFSStack.empty()) {
+
+        Function *F = DFSStack.back().F;
+
+        // Visit the next Callee of the Function on top of the stack.
+        if (DFSStack.back().NextCallee < DFSStack.back().Callees.size()) {
+          Function *Calee = DFSStack.back().Callees[DFSStack.back().NextCallee++];
+
+          if (!DFSIndex.count(Calee))
+            pushFunction(Calee);
+          else if (OnStack[Calee])
+            LowLink[F] = std::min(LowLink[F], DFSIndex[Calee]);
+          continue;
+        }
+
+        // All Callees visited - F is the root of an SCC.
+        if (LowLink[F] == DFSIndex[F]) {
+          std::vector<Function *> SCC;
+          Function *Member;
+          do {
+            Member = SCCStack.back();
+            SCCStack.pop_back();
+            OnStack[Member] = false;
+            SCC.push_back(Member);
+          } while (Member != F);
+
+          SCCs.push_back(SCC);
+        }
+
+        Callees_list[F].swap(DFSStack.back().Callees);
+        DFSStack.pop_back();
+        if (!DFSStack.empty()) {
+          Function *Caller = DFSStack.back().F;
+          LowLink[Caller] = std::min(LowLink[Caller], LowLink[F]);
+        }
+      }
+    }
+
+    for (unsigned int scc = 0; scc < SCCs.size(); scc++)
+      for (unsigned int i = 0; i < SCCs[scc].size(); i++) {
+        TC.Node_Index[SCCs[scc][i]] = TC.Nodes.size();
+        TC.Nodes.push_back(SCCs[scc][i]);
+        TC.SCC_Index[SCCs[scc][i]] = scc;
+      }
+
+    TC.Calls.resize(TC.Nodes.size());
+    for (unsigned int i = 0; i < TC.Nodes.size(); i++) {
+      std::vector<Function *> &Callees = Callees_list[TC.Nodes[i]];
+      for (unsigned int c = 0; c < Callees.size(); c++)
+        TC.Calls[i].push_back(TC.Node_Index[Callees[c]]);
+    }
+
+    // Union of the Callees of all members and of their own Transitive Callees.
+    TC.Reach.assign(SCCs.size(), BitVector(TC.Nodes.size()));
+
+    for (unsigned int scc = 0; scc < SCCs.size(); scc++)
+      for (unsigned int i = 0; i < SCCs[scc].size(); i++) {
+        std::vector<Function *> &Callees = Callees_list[SCCs[scc][i]];
+
+        for (unsigned int c = 0; c < Callees.size(); c++) {
+          TC.Reach[scc].set(TC.Node_Index[Callees[c]]);
+
+          unsigned int CalleeSCC = TC.SCC_Index[Callees[c]];
+          if (CalleeSCC != scc)
+            TC.Reach[scc] |= TC.Reach[CalleeSCC];
+        }
+      }
+  }
+
   //
   //
   bool structNameIsValid(llvm::Type *type) {
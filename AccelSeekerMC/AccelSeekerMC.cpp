@@ -0,0 +1,695 @@
+//===------------------------- AccelSeekerMC.cpp -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file computes the Merit/Cost of the AccelSeeker candidates from the
+// analysis files (LA.txt, IO.txt), in place of the compute_merit.sh,
+// compute_merit_llp.sh and compute_sw_hw.sh scripts.
+//
+// e.g. accelseeker-mc -mode=merit -bench=audiodecoder -alpha=0.1 -overhead=50
+//
+// It also selects the accelerators of MCI.txt that maximize the Merit within
+// an Area budget, under the Overlapping Rule.
+//
+// e.g. accelseeker-mc -mode=select -budget=5000,10000,20000
+//
+// with budgets of FFs, DSPs and BRAMs as well, the Resources of the
+// candidates taken from RES.txt.
+//
+// e.g. accelseeker-mc -mode=select -budget=20000 -budget-dsp=90 -budget-bram=140
+//
+// or the whole Merit vs Area Pareto frontier of the selections.
+//
+// e.g. accelseeker-mc -mode=pareto
+//
+// The Merit/Cost/Indexes of the candidates for a whole grid of ALPHA and
+// OVERHEAD values are computed in a single run as well.
+//
+// e.g. accelseeker-mc -mode=sweep -alpha-grid=0.003125,0.01,0.1,1 -overhead-grid=50,100,200,500
+//
+// and applies the Overlapping Rule on FCI_CROPPED.txt, in place of the
+// generate_overlapping_rule.py script.
+//
+// e.g. accelseeker-mc -mode=overlap
+//
+// and the Merit of the tasks that run in parallel (Task Level Parallelism),
+// in place of the extract_tlp.sh script.
+//
+// e.g. accelseeker-mc -mode=tlp -bench=audiodecoder
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <thread>
+#include <vector>
+#include "AccelSeekerMC.h"
+
+using namespace llvm;
+
+enum ToolMode {
+  MeritMode,      // MC.txt
+  MeritLLPMode,   // MC_HPVM_LLP.txt
+  SWHWMode,       // SW_HW.txt, SW_HW_AREA.txt, INV_IO_OVHD.txt
+  SelectMode,     // SELECTION.txt
+  ParetoMode,     // PARETO.txt
+  SweepMode,      // SWEEP.txt
+  OverlapMode,    // FCI_CROPPED_OVERLAP_RULE.txt
+  TLPMode         // MCI_tlp_con.txt, MCI_tlp_opt.txt
+};
+
+static cl::opt<ToolMode> Mode("mode", cl::desc("What to compute"), cl::init(MeritMode),
+  cl::values(clEnumValN(MeritMode, "merit", "Merit/Cost of the candidates (MC.txt)"),
+             clEnumValN(MeritLLPMode, "merit-llp", "Merit/Cost of the Loop Level Parallelism candidates (MC_HPVM_LLP.txt)"),
+             clEnumValN(SWHWMode, "sw-hw", "SW and total HW Latency of the candidates (SW_HW_AREA.txt)"),
+             clEnumValN(SelectMode, "select", "Selection of accelerators within the Area budgets (SELECTION.txt)"),
+             clEnumValN(ParetoMode, "pareto", "Merit vs Area Pareto frontier of the selections (PARETO.txt)"),
+             clEnumValN(SweepMode, "sweep", "Merit/Cost/Indexes for a grid of ALPHA and OVERHEAD values (SWEEP.txt)"),
+             clEnumValN(OverlapMode, "overlap", "Overlapping Rule on FCI_CROPPED.txt (FCI_CROPPED_OVERLAP_RULE.txt)"),
+             clEnumValN(TLPMode, "tlp", "Merit of the tasks that run in parallel (MCI_tlp_con.txt, MCI_tlp_opt.txt)")));
+
+static cl::opt<std::string> Bench("bench", cl::desc("Name of the Benchmark"), cl::init(""));
+
+static cl::opt<std::string> Alpha("alpha", cl::desc("Cycles per Byte of Input - Based on Memory Hierarchy of the Architecture"),
+  cl::init("0.1"));
+
+static cl::opt<int> Overhead("overhead", cl::desc("Overhead per invocation in Cycles"), cl::init(100));
+
+static cl::opt<std::string> LAFile("la", cl::desc("Latency/Area file (default: LA.txt, LA_HPVM_LLP.txt or LA.LLVM.txt)"),
+  cl::init(""));
+
+static cl::opt<std::string> IOFile("io", cl::desc("IO file (default: IO.txt or IO_HPVM_LLP.txt)"), cl::init(""));
+
+static cl::opt<std::string> FCIFile("fci", cl::desc("Function Call Indexes file (default: FCI.txt or FCI_CROPPED.txt)"),
+  cl::init(""));
+
+static cl::list<std::string> AlphaGrid("alpha-grid", cl::desc("ALPHA values of the sweep (default: -alpha)"),
+  cl::CommaSeparated);
+
+static cl::list<int> OverheadGrid("overhead-grid", cl::desc("OVERHEAD values of the sweep (default: -overhead)"),
+  cl::CommaSeparated);
+
+static cl::opt<unsigned> MaxGroup("max-group", cl::desc("Maximum number of tasks that run in parallel (0: no limit)"),
+  cl::init(0));
+
+static cl::opt<std::string> MCIFile("mci", cl::desc("Accel Candidates list file (default: MCI.txt)"), cl::init(""));
+
+static cl::list<unsigned> Budgets("budget", cl::desc("Area budgets in LUTs (pareto: the largest one bounds the frontier)"),
+  cl::CommaSeparated);
+
+static cl::opt<std::string> RESFile("res", cl::desc("Resources file (default: RES.txt)"), cl::init(""));
+
+static cl::opt<unsigned> BudgetFF("budget-ff", cl::desc("Budget of FFs (0: no limit)"), cl::init(0));
+
+static cl::opt<unsigned> BudgetDSP("budget-dsp", cl::desc("Budget of DSPs (0: no limit)"), cl::init(0));
+
+static cl::opt<unsigned> BudgetBRAM("budget-bram", cl::desc("Budget of BRAMs (0: no limit)"), cl::init(0));
+
+static cl::opt<unsigned> TimeLimit("time-limit", cl::desc("Seconds the selection of every budget may take (0: no limit)"),
+  cl::init(60));
+
+
+// File given on the command line, or the default file of the mode.
+//
+static std::string getFileName(const std::string &Option, std::string Default) {
+  return Option.empty() ? Default : Option;
+}
+
+
+// Merit/Cost of every candidate of LA matched with IO.
+//
+// BENCH FUNC_NAME MERIT INPUT AREA INVOCATIONS
+//
+// Candidates without invocations are left out - or get a zero Merit when
+// KeepNotInvoked is set (Loop Level Parallelism).
+//
+static void writeMeritCost(std::string FileName, const std::vector<LARow> &LA, const std::vector<IORow> &IO,
+                           long long AlphaMantissa, unsigned AlphaScale, bool KeepNotInvoked) {
+
+  StringMap<std::vector<unsigned> > IO_Index;
+  std::string Buffer;
+
+  indexIORows(IO, IO_Index);
+
+  for (unsigned i = 0; i < LA.size(); i++) {
+
+    StringMap<std::vector<unsigned> >::iterator It = IO_Index.find(LA[i].Name);
+    if (It == IO_Index.end())
+      continue;
+
+    for (unsigned j = 0; j < It->second.size(); j++) {
+      const IORow &Row = IO[It->second[j]];
+      std::string Merit = "0";
+
+      if (LA[i].Invocations > 0)
+        Merit = formatDecimal(getMerit(LA[i], Row, AlphaMantissa, AlphaScale, Overhead));
+      else if (!KeepNotInvoked)
+        continue;
+
+      Buffer += Bench + "\t" + LA[i].Name + "\t" + Merit + "\t" + std::to_string(Row.Input) + "\t"
+        + std::to_string(LA[i].Area) + "\t" + std::to_string(LA[i].Invocations) + "\n";
+    }
+  }
+
+  myfile.open (FileName, std::ofstream::out | std::ofstream::trunc);
+  myfile << Buffer;
+  myfile.close();
+}
+
+// SW Latency and total HW Latency (IO and invocation overhead included) of
+// every candidate of LA matched with IO - input of the Task Level Parallelism
+// estimation.
+//
+static void writeSWHW(const std::vector<LARow> &LA, const std::vector<IORow> &IO,
+                      long long AlphaMantissa, unsigned AlphaScale) {
+
+  StringMap<std::vector<unsigned> > IO_Index;
+  std::string SWHW, SWHWArea, InvIOOvhd;
+
+  indexIORows(IO, IO_Index);
+
+  for (unsigned i = 0; i < LA.size(); i++) {
+
+    StringMap<std::vector<unsigned> >::iterator It = IO_Index.find(LA[i].Name);
+    if (It == IO_Index.end())
+      continue;
+
+    for (unsigned j = 0; j < It->second.size(); j++) {
+      const IORow &Row = IO[It->second[j]];
+
+      std::string HWLatencyTotal = formatDecimal(getHWLatencyTotal(LA[i], Row, AlphaMantissa, AlphaScale, Overhead));
+      std::string IOLatency = formatDecimal(addDecimal(0, AlphaMantissa * Row.Input * LA[i].Invocations, AlphaScale, false));
+
+      SWHW      += LA[i].Name + "\t" + std::to_string(LA[i].SW) + "\t" + HWLatencyTotal + "\n";
+      SWHWArea  += LA[i].Name + "\t" + std::to_string(LA[i].SW) + "\t" + HWLatencyTotal + "\t"
+        + std::to_string(LA[i].Area) + "\n";
+      InvIOOvhd += LA[i].Name + "\t" + IOLatency + "\t" + std::to_string(Overhead * LA[i].Invocations) + "\n";
+    }
+  }
+
+  myfile.open ("SW_HW.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << SWHW;
+  myfile.close();
+
+  myfile.open ("SW_HW_AREA.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << SWHWArea;
+  myfile.close();
+
+  myfile.open ("INV_IO_OVHD.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << InvIOOvhd;
+  myfile.close();
+}
+// Resources of every candidate of MCI, from RES. Candidates with a task
+// not in RES are left out of MCI - with no Resources they would pass every
+// Resource budget.
+//
+static void setResources(std::vector<MCIRow> &MCI, const StringMap<std::vector<long long> > &RES) {
+
+  unsigned Kept = 0;
+  for (unsigned i = 0; i < MCI.size(); i++) {
+    if (!getResources(MCI[i].Name, RES, MCI[i].Resources)) {
+      errs() << "warning_no_resources " << MCI[i].Name << " - left out of the selection\n";
+      continue;
+    }
+    MCI[Kept++] = MCI[i];
+  }
+  MCI.resize(Kept);
+}
+
+// Exact selection for every Area budget, within the Resource budgets.
+//
+// BENCH BUDGET MERIT AREA ACCEL_NAME,ACCEL_NAME,...
+//
+// or, with Resource budgets, the Resources the selection takes as well.
+//
+// BENCH BUDGET MERIT AREA FF DSP BRAM ACCEL_NAME,ACCEL_NAME,...
+//
+static void writeSelection(const std::vector<MCIRow> &MCI, const std::vector<long long> &Resource_Budget) {
+
+  std::string Buffer;
+  std::string BenchName = MCI.empty() ? std::string(Bench) : MCI[0].Bench;
+
+  // Enough subtrees to keep every thread busy.
+  unsigned Depth = 0;
+  while (Depth < 16 && (1U << Depth) < 8 * std::max(std::thread::hardware_concurrency(), 1U))
+    Depth++;
+
+  for (unsigned b = 0; b < Budgets.size(); b++) {
+
+    SelectionSolver Solver(MCI, Budgets[b], Resource_Budget, TimeLimit);
+    Selection Result = Solver.solve(Depth);
+
+    if (Solver.Timed_Out)
+      errs() << "warning_time_limit " << Budgets[b] << " - best selection found in " << TimeLimit << " s\n";
+
+    std::string Names;
+    std::vector<long long> Used(NUM_RESOURCES, 0);
+    for (unsigned i = 0; i < Result.Candidates.size(); i++) {
+      const MCIRow &Row = MCI[Result.Candidates[i]];
+      Names += (i ? "," : "") + Row.Name;
+      for (unsigned r = 0; r < Row.Resources.size(); r++)
+        Used[r] += Row.Resources[r];
+    }
+
+    Buffer += BenchName + "\t" + std::to_string(Budgets[b]) + "\t" + std::to_string(Result.Merit) + "\t"
+      + std::to_string(Result.Area) + "\t";
+    if (!Resource_Budget.empty())
+      Buffer += std::to_string(Used[RES_FF]) + "\t" + std::to_string(Used[RES_DSP]) + "\t"
+        + std::to_string(Used[RES_BRAM]) + "\t";
+    Buffer += Names + "\n";
+
+    errs() << "Budget " << Budgets[b] << " Merit " << Result.Merit << " Area " << Result.Area
+           << " " << Names << "\n";
+  }
+
+  myfile.open ("SELECTION.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << Buffer;
+  myfile.close();
+}
+
+// Best selection at every breakpoint of the frontier, by increasing Area.
+//
+// BENCH AREA MERIT ACCEL_NAME,ACCEL_NAME,...
+//
+static void writeParetoFrontier(const std::vector<MCIRow> &MCI) {
+
+  std::string Buffer;
+  std::string BenchName = MCI.empty() ? std::string(Bench) : MCI[0].Bench;
+
+  long long MaxArea = LLONG_MAX;
+  if (!Budgets.empty())
+    MaxArea = *std::max_element(Budgets.begin(), Budgets.end());
+
+  ParetoFrontier Frontier(MCI, MaxArea);
+  std::vector<Selection> Selections = Frontier.solve();
+
+  for (unsigned s = 0; s < Selections.size(); s++) {
+
+    std::string Names;
+    for (unsigned i = 0; i < Selections[s].Candidates.size(); i++)
+      Names += (i ? "," : "") + MCI[Selections[s].Candidates[i]].Name;
+
+    Buffer += BenchName + "\t" + std::to_string(Selections[s].Area) + "\t" + std::to_string(Selections[s].Merit)
+      + "\t" + Names + "\n";
+  }
+
+  errs() << "Pareto Frontier " << Selections.size() << " breakpoints\n";
+
+  myfile.open ("PARETO.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << Buffer;
+  myfile.close();
+}
+
+#define MIN_MERIT 10 // Minimum Merit of the candidates the Overlapping Rule is applied on.
+
+// Merit/Cost/Indexes of the candidates for every ALPHA and OVERHEAD of the
+// grid, with LA, IO and FCI loaded once - what compute_merit.sh,
+// generate_accelcands_list.sh and the Merit filter of filter_mci.sh give
+// for every configuration.
+//
+// ALPHA OVERHEAD BENCH FUNC_NAME MERIT AREA INDEX,INDEX,...
+//
+static bool writeSweep(const std::vector<LARow> &LA, const std::vector<IORow> &IO,
+                       const std::vector<FCIRow> &FCI) {
+
+  std::vector<std::string> Alphas(AlphaGrid.begin(), AlphaGrid.end());
+  std::vector<int> Overheads(OverheadGrid.begin(), OverheadGrid.end());
+  if (Alphas.empty())
+    Alphas.push_back(Alpha);
+  if (Overheads.empty())
+    Overheads.push_back(Overhead);
+
+  std::vector<long long> Alpha_Mantissa(Alphas.size());
+  std::vector<unsigned> Alpha_Scale(Alphas.size());
+  unsigned Scale = 0;
+
+  for (unsigned a = 0; a < Alphas.size(); a++) {
+    if (!parseDecimal(Alphas[a], Alpha_Mantissa[a], Alpha_Scale[a])) {
+      errs() << "error_alpha " << Alphas[a] << "\n";
+      return false;
+    }
+    Scale = std::max(Scale, Alpha_Scale[a]);
+  }
+
+  long long Power = getPowerOf10(Scale);
+
+  // Candidates - LA rows matched with IO, with invocations - as structure of
+  // arrays, the Cycles scaled to the finest ALPHA.
+  StringMap<std::vector<unsigned> > IO_Index;
+  std::vector<unsigned> Candidate_LA;
+  std::vector<long long> Latency_Saved, Invocations, Input_Invocations;
+
+  indexIORows(IO, IO_Index);
+
+  for (unsigned i = 0; i < LA.size(); i++) {
+
+    StringMap<std::vector<unsigned> >::iterator It = IO_Index.find(LA[i].Name);
+    if (It == IO_Index.end() || LA[i].Invocations <= 0)
+      continue;
+
+    for (unsigned j = 0; j < It->second.size(); j++) {
+      Candidate_LA.push_back(i);
+      Latency_Saved.push_back((LA[i].SW - LA[i].HW * LA[i].Invocations) * Power);
+      Invocations.push_back(LA[i].Invocations);
+      Input_Invocations.push_back(IO[It->second[j]].Input * LA[i].Invocations);
+    }
+  }
+
+  StringMap<std::vector<unsigned> > FCI_Index;
+  for (unsigned i = 0; i < FCI.size(); i++)
+    FCI_Index[FCI[i].Name].push_back(i);
+
+  unsigned N = Candidate_LA.size();
+  std::vector<long long> Merit(N);
+  std::string Buffer;
+
+  for (unsigned a = 0; a < Alphas.size(); a++)
+    for (unsigned o = 0; o < Overheads.size(); o++) {
+
+      long long Alpha_Scaled = Alpha_Mantissa[a] * getPowerOf10(Scale - Alpha_Scale[a]);
+      long long Overhead_Scaled = (long long) Overheads[o] * Power;
+
+      // Merit in Cycles, fractional part truncated (remove_fractional_point.sh).
+      for (unsigned i = 0; i < N; i++)
+        Merit[i] = (Latency_Saved[i] - Overhead_Scaled * Invocations[i] - Alpha_Scaled * Input_Invocations[i]) / Power;
+
+      // Indexes of the candidates above MIN_MERIT (prune_fci_files.sh).
+      std::vector<FCIRow> Cropped;
+      for (unsigned i = 0; i < N; i++) {
+        if (Merit[i] <= MIN_MERIT)
+          continue;
+
+        StringMap<std::vector<unsigned> >::iterator It = FCI_Index.find(LA[Candidate_LA[i]].Name);
+        if (It != FCI_Index.end())
+          for (unsigned j = 0; j < It->second.size(); j++)
+            Cropped.push_back(FCI[It->second[j]]);
+      }
+
+      applyOverlapRule(Cropped);
+
+      StringMap<std::vector<unsigned> > Cropped_Index;
+      for (unsigned i = 0; i < Cropped.size(); i++)
+        Cropped_Index[Cropped[i].Name].push_back(i);
+
+      std::string Config = Alphas[a] + " " + std::to_string(Overheads[o]) + " ";
+
+      for (unsigned i = 0; i < N; i++) {
+        const LARow &Row = LA[Candidate_LA[i]];
+
+        StringMap<std::vector<unsigned> >::iterator It = Cropped_Index.find(Row.Name);
+        if (Merit[i] <= 0 || It == Cropped_Index.end())
+          continue;
+
+        for (unsigned j = 0; j < It->second.size(); j++) {
+          const std::vector<unsigned> &Indexes = Cropped[It->second[j]].Indexes;
+
+          std::string Index_List;
+          for (unsigned k = 0; k < Indexes.size(); k++)
+            Index_List += (k ? "," : "") + std::to_string(Indexes[k]);
+
+          Buffer += Config + Bench + " " + Row.Name + " " + std::to_string(Merit[i]) + " "
+            + std::to_string(Row.Area) + " " + Index_List + "\n";
+        }
+      }
+    }
+
+  myfile.open ("SWEEP.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << Buffer;
+  myfile.close();
+
+  return true;
+}
+
+// Cropped FCI rows after the Overlapping Rule, in the format of
+// generate_overlapping_rule.py.
+//
+// FUNC_NAME\tINDEX INDEX ...
+//
+static void writeOverlapRule(std::vector<FCIRow> &FCI) {
+
+  std::string Buffer;
+
+  applyOverlapRule(FCI);
+
+  for (unsigned i = 0; i < FCI.size(); i++) {
+    Buffer += FCI[i].Name + "\t";
+    for (unsigned j = 0; j < FCI[i].Indexes.size(); j++)
+      Buffer += (j ? " " : "") + std::to_string(FCI[i].Indexes[j]);
+    Buffer += FCI[i].Indexes.size() == 2 ? " \n" : "\n";
+  }
+  Buffer += "\n";
+
+  myfile.open ("FCI_CROPPED_OVERLAP_RULE.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << Buffer;
+  myfile.close();
+}
+
+// Merit of every group of tasks that run in parallel - a task of
+// parallel_tasks.txt along with any of the tasks of its row that also run
+// in parallel to each other. The tasks run concurrently in HW, so the group
+// saves the SW Latency of all of them minus the longest HW Latency, minus
+// the spread of their Earliest Start Times:
+//
+//   conservative - SW Earliest Start Times (SW-only implementation before),
+//   optimistic   - HW Earliest Start Times (HW-only implementation before).
+//
+// BENCH TASK.TASK... MERIT AREA INDEX,INDEX,...
+//
+static bool writeTaskLevelParallelism() {
+
+  struct Task {
+    long long SW, HW, Area;
+    long long SW_EST, HW_EST;
+    std::string Indexes;
+  };
+
+  std::unique_ptr<MemoryBuffer> SWHW_Buffer, EST_Buffer, Tasks_Buffer;
+  std::vector<SmallVector<StringRef, 8> > SWHW_Rows, EST_Rows, Parallel_Tasks;
+  std::vector<MCIRow> MCI;
+
+  if (!readFields("SW_HW_AREA.txt", SWHW_Rows, SWHW_Buffer) || !readFields("earliest_start.txt", EST_Rows, EST_Buffer)
+      || !readFields("parallel_tasks.txt", Parallel_Tasks, Tasks_Buffer)
+      || !readMCIFile(getFileName(MCIFile, "MCI.txt"), MCI))
+    return false;
+
+  // Tasks not listed get zero Latencies and no Indexes. Last row wins.
+  StringMap<Task> Tasks;
+
+  for (unsigned i = 0; i < SWHW_Rows.size(); i++)
+    if (SWHW_Rows[i].size() >= 4) {
+      Task &T = Tasks[SWHW_Rows[i][0]];
+      T.SW = getInteger(SWHW_Rows[i][1]);
+      T.HW = getInteger(SWHW_Rows[i][2]);
+      T.Area = getInteger(SWHW_Rows[i][3]);
+    }
+
+  for (unsigned i = 0; i < EST_Rows.size(); i++)
+    if (EST_Rows[i].size() >= 3) {
+      Task &T = Tasks[EST_Rows[i][0]];
+      T.SW_EST = getInteger(EST_Rows[i][1]);
+      T.HW_EST = getInteger(EST_Rows[i][2]);
+    }
+
+  for (unsigned i = 0; i < MCI.size(); i++) {
+    Task &T = Tasks[MCI[i].Name];
+    T.Indexes.clear();
+    for (unsigned j = 0; j < MCI[i].Indexes.size(); j++)
+      T.Indexes += (j ? "," : "") + std::to_string(MCI[i].Indexes[j]);
+  }
+
+  // Two tasks run in parallel when either one lists the other.
+  StringMap<StringSet<> > Parallel;
+  for (unsigned i = 0; i < Parallel_Tasks.size(); i++)
+    for (unsigned j = 1; j < Parallel_Tasks[i].size(); j++) {
+      Parallel[Parallel_Tasks[i][0]].insert(Parallel_Tasks[i][j]);
+      Parallel[Parallel_Tasks[i][j]].insert(Parallel_Tasks[i][0]);
+    }
+
+  std::string Conservative, Optimistic;
+
+  for (unsigned i = 0; i < Parallel_Tasks.size(); i++) {
+
+    const SmallVector<StringRef, 8> &Row = Parallel_Tasks[i];
+    unsigned Num_Partners = Row.size() - 1;
+    unsigned Max_Partners = MaxGroup ? std::min(Num_Partners, MaxGroup - 1) : Num_Partners;
+
+    // Partners of the task, by group size and in row order.
+    for (unsigned Size = 1; Size <= Max_Partners; Size++) {
+
+      std::vector<unsigned> Group;
+      for (unsigned k = 1; k <= Size; k++)
+        Group.push_back(k);
+
+      while (true) {
+
+        bool Valid = true;
+        for (unsigned a = 0; a < Size && Valid; a++)
+          for (unsigned b = a + 1; b < Size && Valid; b++)
+            Valid = Parallel[Row[Group[a]]].count(Row[Group[b]]);
+
+        if (Valid) {
+          Task &First = Tasks[Row[0]];
+          std::string Name = Row[0].str(), Indexes = First.Indexes;
+          long long Sum_SW = First.SW, Max_HW = First.HW, Area = First.Area;
+          long long Min_SW_EST = First.SW_EST, Max_SW_EST = First.SW_EST;
+          long long Min_HW_EST = First.HW_EST, Max_HW_EST = First.HW_EST;
+
+          for (unsigned k = 0; k < Size; k++) {
+            Task &T = Tasks[Row[Group[k]]];
+            Name += "." + Row[Group[k]].str();
+            Indexes += "," + T.Indexes;
+            Sum_SW += T.SW;
+            Max_HW = std::max(Max_HW, T.HW);
+            Area += T.Area;
+            Min_SW_EST = std::min(Min_SW_EST, T.SW_EST);
+            Max_SW_EST = std::max(Max_SW_EST, T.SW_EST);
+            Min_HW_EST = std::min(Min_HW_EST, T.HW_EST);
+            Max_HW_EST = std::max(Max_HW_EST, T.HW_EST);
+          }
+
+          long long Merit = Sum_SW - Max_HW;
+          std::string Rest = " " + std::to_string(Area) + " " + Indexes + "\n";
+
+          Conservative += Bench + " " + Name + " " + std::to_string(Merit - (Max_SW_EST - Min_SW_EST)) + Rest;
+          Optimistic += Bench + " " + Name + " " + std::to_string(Merit - (Max_HW_EST - Min_HW_EST)) + Rest;
+        }
+
+        // Next combination of Size partners.
+        int k = Size - 1;
+        while (k >= 0 && Group[k] == Num_Partners - (Size - 1 - k))
+          k--;
+        if (k < 0)
+          break;
+        Group[k]++;
+        for (unsigned l = k + 1; l < Size; l++)
+          Group[l] = Group[l - 1] + 1;
+      }
+    }
+  }
+
+  myfile.open ("MCI_tlp_con.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << Conservative;
+  myfile.close();
+
+  myfile.open ("MCI_tlp_opt.txt", std::ofstream::out | std::ofstream::trunc);
+  myfile << Optimistic;
+  myfile.close();
+
+  return true;
+}
+
+
+
+int main(int argc, char **argv) {
+
+  InitLLVM X(argc, argv);
+  cl::ParseCommandLineOptions(argc, argv, "AccelSeeker Merit/Cost estimation\n");
+
+  long long AlphaMantissa;
+  unsigned AlphaScale;
+
+  if (!parseDecimal(Alpha, AlphaMantissa, AlphaScale)) {
+    errs() << "error_alpha " << Alpha << "\n";
+    return 1;
+  }
+
+  std::vector<LARow> LA;
+  std::vector<IORow> IO;
+
+  switch (Mode) {
+
+  case MeritMode:
+    if (!readLAFile(getFileName(LAFile, "LA.txt"), LA) || !readIOFile(getFileName(IOFile, "IO.txt"), IO))
+      return 1;
+    writeMeritCost("MC.txt", LA, IO, AlphaMantissa, AlphaScale, false);
+    break;
+
+  case MeritLLPMode:
+    if (!readLAFile(getFileName(LAFile, "LA_HPVM_LLP.txt"), LA)
+        || !readIOFile(getFileName(IOFile, "IO_HPVM_LLP.txt"), IO))
+      return 1;
+    writeMeritCost("MC_HPVM_LLP.txt", LA, IO, AlphaMantissa, AlphaScale, true);
+    break;
+
+  case SWHWMode:
+    if (!readLAFile(getFileName(LAFile, "LA.LLVM.txt"), LA) || !readIOFile(getFileName(IOFile, "IO.txt"), IO))
+      return 1;
+    writeSWHW(LA, IO, AlphaMantissa, AlphaScale);
+    break;
+
+  case SelectMode: {
+    std::vector<MCIRow> MCI;
+    if (!readMCIFile(getFileName(MCIFile, "MCI.txt"), MCI))
+      return 1;
+
+    // Resources only read when they have a budget.
+    std::vector<long long> Resource_Budget;
+    if (BudgetFF || BudgetDSP || BudgetBRAM) {
+      StringMap<std::vector<long long> > RES;
+      if (!readRESFile(getFileName(RESFile, "RES.txt"), RES))
+        return 1;
+      setResources(MCI, RES);
+      Resource_Budget = {BudgetFF, BudgetDSP, BudgetBRAM};
+    }
+    writeSelection(MCI, Resource_Budget);
+    break;
+  }
+
+  case ParetoMode: {
+    std::vector<MCIRow> MCI;
+    if (!readMCIFile(getFileName(MCIFile, "MCI.txt"), MCI))
+      return 1;
+    writeParetoFrontier(MCI);
+    break;
+  }
+
+  case SweepMode: {
+    std::vector<FCIRow> FCI;
+    if (!readLAFile(getFileName(LAFile, "LA.txt"), LA) || !readIOFile(getFileName(IOFile, "IO.txt"), IO)
+        || !readFCIFile(getFileName(FCIFile, "FCI.txt"), FCI))
+      return 1;
+    if (!writeSweep(LA, IO, FCI))
+      return 1;
+    break;
+  }
+
+  case OverlapMode: {
+    std::vector<FCIRow> FCI;
+    if (!readFCIFile(getFileName(FCIFile, "FCI_CROPPED.txt"), FCI))
+      return 1;
+    writeOverlapRule(FCI);
+    break;
+  }
+
+  case TLPMode:
+    if (!writeTaskLevelParallelism())
+      return 1;
+    break;
+  }
+
+  return 0;
+}
@@ -0,0 +1,1028 @@
+//===------------------------- AccelSeekerMC.h -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the Università della Svizzera italiana (USI)
+// Open Source License.
+//
+//===----------------------------------------------------------------------===//
+//
+// Helpers of the AccelSeeker Merit/Cost tool: readers of the analysis files
+// (LA.txt, IO.txt, RES.txt) and the decimal arithmetic the scripts did with bc.
+//
+//===----------------------------------------------------------------------===//
+
+
+using namespace llvm;
+
+std::ofstream myfile; // File that Merit/Cost info is written.
+
+namespace {
+
+  // A row of LA.txt - Latency and Area of a candidate.
+  //
+  struct LARow {
+    std::string Name;
+    long long SW, HW, Area, Invocations;
+  };
+
+  // A row of IO.txt - Input Data (Bytes) of a candidate.
+  //
+  struct IORow {
+    std::string Name;
+    long long Input;
+  };
+
+
+  // Split a file in lines of whitespace separated fields, the way
+  // "while read A B C" does. Empty lines are skipped.
+  //
+  bool readFields(StringRef FileName, std::vector<SmallVector<StringRef, 8> > &Rows,
+                  std::unique_ptr<MemoryBuffer> &Buffer) {
+
+    ErrorOr<std::unique_ptr<MemoryBuffer> > File = MemoryBuffer::getFile(FileName);
+    if (!File) {
+      errs() << "error_file " << FileName << "\n";
+      return false;
+    }
+    Buffer = std::move(*File);
+
+    SmallVector<StringRef, 256> Lines;
+    Buffer->getBuffer().split(Lines, '\n', -1, false);
+
+    for (unsigned i = 0; i < Lines.size(); i++) {
+      SmallVector<StringRef, 8> Fields;
+      SplitString(Lines[i], Fields, " \t\r");
+      if (!Fields.empty())
+        Rows.push_back(Fields);
+    }
+    return true;
+  }
+
+  long long getInteger(StringRef Field) {
+
+    long long Value = 0;
+    if (Field.getAsInteger(10, Value))
+      errs() << "error_number " << Field << "\n";
+    return Value;
+  }
+
+  // FUNC_NAME SW_LATENCY HW_LATENCY AREA INVOCATIONS
+  //
+  bool readLAFile(StringRef FileName, std::vector<LARow> &LA) {
+
+    std::unique_ptr<MemoryBuffer> Buffer;
+    std::vector<SmallVector<StringRef, 8> > Rows;
+
+    if (!readFields(FileName, Rows, Buffer))
+      return false;
+
+    for (unsigned i = 0; i < Rows.size(); i++) {
+      if (Rows[i].size() < 5)
+        continue;
+      LARow Row = {Rows[i][0].str(), getInteger(Rows[i][1]), getInteger(Rows[i][2]),
+                   getInteger(Rows[i][3]), getInteger(Rows[i][4])};
+      LA.push_back(Row);
+    }
+    return true;
+  }
+
+  // FUNC_NAME INPUT [OUTPUT]
+  //
+  bool readIOFile(StringRef FileName, std::vector<IORow> &IO) {
+
+    std::unique_ptr<MemoryBuffer> Buffer;
+    std::vector<SmallVector<StringRef, 8> > Rows;
+
+    if (!readFields(FileName, Rows, Buffer))
+      return false;
+
+    for (unsigned i = 0; i < Rows.size(); i++) {
+      if (Rows[i].size() < 2)
+        continue;
+      IORow Row = {Rows[i][0].str(), getInteger(Rows[i][1])};
+      IO.push_back(Row);
+    }
+    return true;
+  }
+
+  // FPGA Resources of a candidate besides its Area (LUTs).
+  //
+  enum ResourceKind { RES_FF, RES_DSP, RES_BRAM, NUM_RESOURCES };
+
+  // FUNC_NAME LUT FF DSP BRAM - LUTs are the Area of LA.txt.
+  //
+  bool readRESFile(StringRef FileName, StringMap<std::vector<long long> > &RES) {
+
+    std::unique_ptr<MemoryBuffer> Buffer;
+    std::vector<SmallVector<StringRef, 8> > Rows;
+
+    if (!readFields(FileName, Rows, Buffer))
+      return false;
+
+    for (unsigned i = 0; i < Rows.size(); i++) {
+      if (Rows[i].size() < 5)
+        continue;
+      std::vector<long long> &Resources = RES[Rows[i][0]];
+      Resources.assign(NUM_RESOURCES, 0);
+      for (unsigned r = 0; r < NUM_RESOURCES; r++)
+        Resources[r] = getInteger(Rows[i][r + 2]);
+    }
+    return true;
+  }
+
+  // Resources of a candidate by its name: a Loop Level Parallelism candidate
+  // (FUNC-N) takes N times the Resources of FUNC, a group of tasks that run in
+  // parallel (TASK.TASK...) the Resources of all of them. The names of the
+  // tasks may hold a '.' themselves (e.g. f.constprop.0), so every '.' is
+  // tried in turn as the end of the first task. False when a task has no
+  // Resources listed.
+  //
+  bool getResources(StringRef Name, const StringMap<std::vector<long long> > &RES,
+                    std::vector<long long> &Resources) {
+
+    Resources.assign(NUM_RESOURCES, 0);
+
+    StringMap<std::vector<long long> >::const_iterator It = RES.find(Name);
+    if (It != RES.end()) {
+      Resources = It->second;
+      return true;
+    }
+
+    std::pair<StringRef, StringRef> LLP = Name.rsplit('-');
+    unsigned Factor;
+    if (!LLP.second.empty() && !LLP.second.getAsInteger(10, Factor) && RES.count(LLP.first)) {
+      Resources = RES.find(LLP.first)->second;
+      for (unsigned r = 0; r < NUM_RESOURCES; r++)
+        Resources[r] *= Factor;
+      return true;
+    }
+
+    for (size_t Dot = Name.find('.'); Dot != StringRef::npos; Dot = Name.find('.', Dot + 1)) {
+      std::vector<long long> Task_Resources, Rest_Resources;
+      if (Dot == 0 || !getResources(Name.substr(0, Dot), RES, Task_Resources)
+          || !getResources(Name.substr(Dot + 1), RES, Rest_Resources))
+        continue;
+
+      for (unsigned r = 0; r < NUM_RESOURCES; r++)
+        Resources[r] = Task_Resources[r] + Rest_Resources[r];
+      return true;
+    }
+    return false;
+  }
+
+  // A row of MCI.txt - Merit, Cost (LUTs) and Function Indexes of a candidate,
+  // and its Resources from RES.txt when there are Resource budgets.
+  //
+  struct MCIRow {
+    std::string Bench, Name;
+    long long Merit, Area;
+    std::vector<unsigned> Indexes;
+    std::vector<long long> Resources; // Indexed by ResourceKind.
+  };
+
+  // BENCH FUNC_NAME MERIT AREA INDEX,INDEX,... - repeated indexes (the
+  // IND1,IND2 of TLP candidates) dropped, first one kept.
+  //
+  bool readMCIFile(StringRef FileName, std::vector<MCIRow> &MCI) {
+
+    std::unique_ptr<MemoryBuffer> Buffer;
+    std::vector<SmallVector<StringRef, 8> > Rows;
+
+    if (!readFields(FileName, Rows, Buffer))
+      return false;
+
+    for (unsigned i = 0; i < Rows.size(); i++) {
+      if (Rows[i].size() < 5)
+        continue;
+      MCIRow Row = {Rows[i][0].str(), Rows[i][1].str(), getInteger(Rows[i][2]), getInteger(Rows[i][3]),
+                    std::vector<unsigned>(), std::vector<long long>()};
+
+      SmallVector<StringRef, 8> Indexes;
+      SmallSet<unsigned, 8> Seen;
+      Rows[i][4].split(Indexes, ',', -1, false);
+      for (unsigned j = 0; j < Indexes.size(); j++)
+        if (Seen.insert(getInteger(Indexes[j])).second)
+          Row.Indexes.push_back(getInteger(Indexes[j]));
+
+      MCI.push_back(Row);
+    }
+    return true;
+  }
+
+  // A row of FCI.txt - Function Call Indexes of a candidate.
+  //
+  struct FCIRow {
+    std::string Name;
+    std::vector<unsigned> Indexes;
+  };
+
+  // FUNC_NAME INDEX INDEX ... - repeated indexes dropped, first one kept.
+  //
+  bool readFCIFile(StringRef FileName, std::vector<FCIRow> &FCI) {
+
+    std::unique_ptr<MemoryBuffer> Buffer;
+    std::vector<SmallVector<StringRef, 8> > Rows;
+
+    if (!readFields(FileName, Rows, Buffer))
+      return false;
+
+    for (unsigned i = 0; i < Rows.size(); i++) {
+      FCIRow Row = {Rows[i][0].str(), std::vector<unsigned>()};
+      StringSet<> Fields;
+
+      for (unsigned j = 1; j < Rows[i].size(); j++)
+        if (Fields.insert(Rows[i][j]).second)
+          Row.Indexes.push_back(getInteger(Rows[i][j]));
+
+      FCI.push_back(Row);
+    }
+    return true;
+  }
+
+  // Index the IO rows by name. A name may be listed more than once.
+  //
+  void indexIORows(const std::vector<IORow> &IO, StringMap<std::vector<unsigned> > &IO_Index) {
+
+    for (unsigned i = 0; i < IO.size(); i++)
+      IO_Index[IO[i].Name].push_back(i);
+  }
+
+
+  // Overlapping Rule on the cropped FCI rows (generate_overlapping_rule.py):
+  // the first two indexes of a row are kept, the following ones only when
+  // they are the second index of some row. The second indexes are kept in a
+  // bitset over the Function Indexes, so every index is a single bit test.
+  //
+  void applyOverlapRule(std::vector<FCIRow> &FCI) {
+
+    unsigned Num_Indexes = 0;
+    for (unsigned i = 0; i < FCI.size(); i++)
+      for (unsigned j = 0; j < FCI[i].Indexes.size(); j++)
+        Num_Indexes = std::max(Num_Indexes, FCI[i].Indexes[j] + 1);
+
+    BitVector Pivots(Num_Indexes);
+    for (unsigned i = 0; i < FCI.size(); i++)
+      if (FCI[i].Indexes.size() >= 2)
+        Pivots.set(FCI[i].Indexes[1]);
+
+    for (unsigned i = 0; i < FCI.size(); i++) {
+      std::vector<unsigned> &Indexes = FCI[i].Indexes;
+      if (Indexes.size() <= 2)
+        continue;
+
+      unsigned Kept = 2;
+      for (unsigned j = 2; j < Indexes.size(); j++)
+        if (Pivots.test(Indexes[j]))
+          Indexes[Kept++] = Indexes[j];
+      Indexes.resize(Kept);
+    }
+  }
+
+
+  // Decimal number as bc keeps it: |Value| = Int + Frac / 10^Scale.
+  //
+  // The merits are computed exactly at the scale of ALPHA - what bc does for
+  // ALPHA * INPUT * INVOCATIONS under "scale=2" - so that the truncation of
+  // the fractional part (remove_fractional_point.sh) gives the same integers.
+  //
+  struct Decimal {
+    bool Negative;
+    long long Int;
+    long long Frac;
+    unsigned Scale;
+  };
+
+  long long getPowerOf10(unsigned Scale) {
+
+    long long Power = 1;
+    for (unsigned i = 0; i < Scale; i++)
+      Power *= 10;
+    return Power;
+  }
+
+  // Parse a non-negative decimal (e.g. 0.003125) as Mantissa / 10^Scale.
+  //
+  bool parseDecimal(StringRef Str, long long &Mantissa, unsigned &Scale) {
+
+    std::pair<StringRef, StringRef> Parts = Str.split('.');
+    long long Int = 0, Frac = 0;
+
+    if (!Parts.first.empty() && Parts.first.getAsInteger(10, Int))
+      return false;
+    if (!Parts.second.empty() && Parts.second.getAsInteger(10, Frac))
+      return false;
+
+    Scale = Parts.second.size();
+    Mantissa = Int * getPowerOf10(Scale) + Frac;
+    return true;
+  }
+
+  // Integer A plus or minus the non-negative Mantissa / 10^Scale.
+  //
+  Decimal addDecimal(long long A, long long Mantissa, unsigned Scale, bool Subtract) {
+
+    long long Power = getPowerOf10(Scale);
+    long long Int = Mantissa / Power, Frac = Mantissa % Power;
+    Decimal D = {false, 0, 0, Scale};
+
+    if (!Subtract) {
+      D.Int = A + Int;
+      D.Frac = Frac;
+      if (D.Int < 0) { // Negative A only.
+        D.Negative = true;
+        D.Int = -D.Int;
+        if (Frac) {
+          D.Int -= 1;
+          D.Frac = Power - Frac;
+        }
+      }
+    }
+    else if (A - Int > 0 || (A - Int == 0 && Frac == 0)) {
+      D.Int = A - Int;
+      if (Frac) {
+        D.Int -= 1;
+        D.Frac = Power - Frac;
+      }
+    }
+    else {
+      D.Negative = true;
+      D.Int = Int - A;
+      D.Frac = Frac;
+    }
+    return D;
+  }
+
+  // Print as bc does: no leading zero before the point, plain 0 for zero.
+  //
+  std::string formatDecimal(const Decimal &D) {
+
+    if (D.Int == 0 && D.Frac == 0)
+      return "0";
+
+    std::string Str = D.Negative ? "-" : "";
+    if (D.Int != 0 || D.Scale == 0)
+      Str += std::to_string(D.Int);
+
+    if (D.Scale > 0) {
+      std::string Frac = std::to_string(D.Frac);
+      Str += "." + std::string(D.Scale - Frac.size(), '0') + Frac;
+    }
+    return Str;
+  }
+
+
+  // Merit of a candidate in Cycles saved.
+  //
+  // MERIT = SW - HW * INVOCATIONS - OVERHEAD * INVOCATIONS - ALPHA * INPUT * INVOCATIONS
+  //
+  Decimal getMerit(const LARow &LA, const IORow &IO, long long AlphaMantissa,
+                   unsigned AlphaScale, long long Overhead) {
+
+    long long IOLatency = AlphaMantissa * IO.Input * LA.Invocations;
+
+    return addDecimal(LA.SW - LA.HW * LA.Invocations - Overhead * LA.Invocations,
+                      IOLatency, AlphaScale, true);
+  }
+
+  // Total HW Latency of a candidate, IO and invocation overhead included.
+  //
+  Decimal getHWLatencyTotal(const LARow &LA, const IORow &IO, long long AlphaMantissa,
+                            unsigned AlphaScale, long long Overhead) {
+
+    long long IOLatency = AlphaMantissa * IO.Input * LA.Invocations;
+
+    return addDecimal(Overhead * LA.Invocations + LA.HW * LA.Invocations,
+                      IOLatency, AlphaScale, false);
+  }
+
+
+
+  // Exact selection of the candidates of MCI that maximize the Merit within
+  // an Area budget under the Overlapping Rule: no two selected candidates
+  // share a Function Index. FFs, DSPs and BRAMs have a budget of their own
+  // as well (0: no limit).
+  //
+  // Branch and bound over the candidates, each followed by the ones whose
+  // Function Indexes it contains. A subtree is pruned when its Merit plus an
+  // upper bound of the Merit of the remaining candidates cannot beat the
+  // best selection found:
+  //   - a knapsack DP that keeps the conflicts of a candidate with the ones
+  //     right after it (all of them for nested index sets), with the Area
+  //     scaled down to at most MAX_DP_CAPACITY steps,
+  //   - a fractional knapsack of the candidates not in conflict with the
+  //     chosen ones,
+  //   - the best Merit share of every Function Index.
+  // The subtrees of the first decisions are explored on a thread pool that
+  // shares the best Merit found so far. The bounds relax the Resource budgets,
+  // so they hold with them as well. Past the time limit, the search stops
+  // with the best selection found so far.
+  //
+  // When the index sets nest, the DP kept with the Area in LUTs gives the
+  // best selection directly (up to MAX_NESTED_DP_CELLS candidates x LUTs).
+  //
+  #define MAX_DP_CAPACITY 4096
+  #define MAX_NESTED_DP_CELLS (1ULL << 28)
+
+  struct Selection {
+    long long Merit;
+    long long Area;
+    std::vector<unsigned> Candidates; // Rows of MCI.
+  };
+
+  struct SelectionSolver {
+
+    // A node of the search tree: the decisions up to Pos are taken.
+    struct Node {
+      unsigned Pos;
+      long long Merit, Area;
+      BitVector Blocked;            // Candidates in conflict with the chosen ones.
+      std::vector<unsigned> Chosen; // Positions in Order.
+      long long Used[NUM_RESOURCES];
+    };
+
+    const std::vector<MCIRow> &MCI;
+    long long Budget;
+    std::vector<long long> Resource_Budget;      // Indexed by ResourceKind, 0: no limit.
+    long long Granularity;
+    std::vector<unsigned> Order;                 // Candidates that fit in the budget, supersets first.
+    std::vector<unsigned> Skip;                  // Per position in Order, end of the ones it excludes right after it.
+    std::vector<unsigned> Ratio_Order;           // Positions in Order, best Merit/Area first.
+    unsigned Num_Indexes;                        // Function Indexes are below.
+    std::vector<BitVector> Conflicts;            // Per position in Order.
+    std::vector<std::vector<long long> > Bound;  // Bound[Pos][Area / Granularity]
+    std::atomic<long long> BestMerit;
+    unsigned Time_Limit;                         // Seconds, 0: no limit.
+    std::chrono::steady_clock::time_point Deadline;
+    std::atomic<bool> Timed_Out;                 // The best selection found in time, not proven the best.
+
+    SelectionSolver(const std::vector<MCIRow> &MCI, long long Budget, const std::vector<long long> &Resource_Budget,
+                    unsigned Time_Limit)
+      : MCI(MCI), Budget(Budget), Resource_Budget(Resource_Budget), Granularity(Budget / MAX_DP_CAPACITY + 1),
+        BestMerit(0), Time_Limit(Time_Limit), Timed_Out(false) {
+
+      // Candidates that share a Function Index exclude each other. They are
+      // ordered depth first over their index sets, larger sets first: every
+      // candidate is followed by the candidates whose indexes it contains, so
+      // the candidates a choice excludes come right after it - all of them
+      // when the index sets nest, as the FCI sets of a call tree do.
+      std::vector<unsigned> Candidates;
+      long long NoneUsed[NUM_RESOURCES] = {0};
+
+      Num_Indexes = 0;
+      for (unsigned i = 0; i < MCI.size(); i++)
+        if (MCI[i].Merit > 0 && MCI[i].Area <= Budget && fits(NoneUsed, MCI[i])) {
+          Candidates.push_back(i);
+          for (unsigned j = 0; j < MCI[i].Indexes.size(); j++)
+            Num_Indexes = std::max(Num_Indexes, MCI[i].Indexes[j] + 1);
+        }
+
+      std::vector<BitVector> Indexes(MCI.size());
+      for (unsigned i = 0; i < Candidates.size(); i++) {
+        Indexes[Candidates[i]].resize(Num_Indexes);
+        for (unsigned j = 0; j < MCI[Candidates[i]].Indexes.size(); j++)
+          Indexes[Candidates[i]].set(MCI[Candidates[i]].Indexes[j]);
+      }
+
+      // Larger sets first, best Merit/Area first among sets of the same size.
+      auto getRatio = [&MCI](unsigned C) { return (double) MCI[C].Merit / std::max(MCI[C].Area, 1LL); };
+
+      std::stable_sort(Candidates.begin(), Candidates.end(), [&Indexes, &getRatio](unsigned A, unsigned B) {
+        unsigned Size_A = Indexes[A].count(), Size_B = Indexes[B].count();
+        return Size_A > Size_B || (Size_A == Size_B && getRatio(A) > getRatio(B));
+      });
+
+      // The subsets of a set come after it in Candidates.
+      BitVector Placed(Candidates.size());
+      std::vector<std::pair<unsigned, unsigned> > Walk; // Candidate, next one to check.
+
+      for (unsigned i = 0; i < Candidates.size(); i++) {
+        if (Placed.test(i))
+          continue;
+
+        Placed.set(i);
+        Order.push_back(Candidates[i]);
+        Walk.push_back(std::make_pair(i, i + 1));
+
+        while (!Walk.empty()) {
+          const BitVector &Set = Indexes[Candidates[Walk.back().first]];
+          unsigned &Next = Walk.back().second;
+
+          while (Next < Candidates.size() && (Placed.test(Next) || Indexes[Candidates[Next]].none()
+                                              || Indexes[Candidates[Next]].test(Set)))
+            Next++;
+
+          if (Next == Candidates.size()) {
+            Walk.pop_back();
+            continue;
+          }
+
+          Placed.set(Next);
+          Order.push_back(Candidates[Next]);
+          Walk.push_back(std::make_pair(Next, Next + 1));
+        }
+      }
+
+      for (unsigned i = 0; i < Order.size(); i++)
+        Ratio_Order.push_back(i);
+      std::stable_sort(Ratio_Order.begin(), Ratio_Order.end(), [this, &getRatio](unsigned A, unsigned B) {
+        return getRatio(Order[A]) > getRatio(Order[B]);
+      });
+
+      Conflicts.assign(Order.size(), BitVector(Order.size()));
+      for (unsigned i = 0; i < Order.size(); i++)
+        for (unsigned j = i + 1; j < Order.size(); j++)
+          if (Indexes[Order[i]].anyCommon(Indexes[Order[j]])) {
+            Conflicts[i].set(j);
+            Conflicts[j].set(i);
+          }
+
+      // The candidates right after a chosen one that it excludes.
+      Skip.resize(Order.size());
+      for (unsigned i = 0; i < Order.size(); i++)
+        for (Skip[i] = i + 1; Skip[i] < Order.size() && Conflicts[i].test(Skip[i]); Skip[i]++)
+          ;
+
+      // Knapsack where a chosen candidate skips the ones up to Skip, the other
+      // conflicts ignored. Exact when the index sets nest. Area and capacity
+      // rounded down: still an upper bound.
+      unsigned Capacity = Budget / Granularity;
+      Bound.assign(Order.size() + 1, std::vector<long long>(Capacity + 1, 0));
+
+      for (int i = Order.size() - 1; i >= 0; i--) {
+        long long Area = MCI[Order[i]].Area / Granularity;
+        const std::vector<long long> &After_Skip = Bound[Skip[i]];
+
+        for (unsigned c = 0; c <= Capacity; c++) {
+          Bound[i][c] = Bound[i + 1][c];
+          if (Area <= c)
+            Bound[i][c] = std::max(Bound[i][c], MCI[Order[i]].Merit + After_Skip[c - Area]);
+        }
+      }
+    }
+
+    // Fractional knapsack over the candidates still available below N - the
+    // conflicts with the chosen candidates are kept, the ones among the
+    // remaining candidates are ignored.
+    //
+    long long getFractionalBound(const Node &N, double &Lambda) {
+
+      long long Area = Budget - N.Area;
+      long long Merit = 0;
+
+      Lambda = 0;
+
+      for (unsigned i = 0; i < Ratio_Order.size() && Area > 0; i++) {
+        unsigned Pos = Ratio_Order[i];
+        if (Pos < N.Pos || N.Blocked.test(Pos))
+          continue;
+
+        const MCIRow &Row = MCI[Order[Pos]];
+        if (Row.Area <= Area) {
+          Merit += Row.Merit;
+          Area -= Row.Area;
+        }
+        else {
+          Merit += (long long) ceil((double) Row.Merit * Area / Row.Area);
+          Area = 0;
+          Lambda = (double) Row.Merit / Row.Area;
+        }
+      }
+      return Merit;
+    }
+
+    // Every Function Index is covered at most once: the Merit of a selection
+    // spread evenly over the indexes of its candidates is at most the sum of
+    // the best share of every index. The Area budget is relaxed with a
+    // Lagrangian multiplier Lambda (Cycles per LUT): every candidate pays
+    // Lambda * Area and the remaining budget earns Lambda * Area.
+    //
+    long long getIndexBound(const Node &N, double Lambda, std::vector<double> &Index_Merit) {
+
+      std::fill(Index_Merit.begin(), Index_Merit.end(), 0);
+      double Merit = Lambda * (Budget - N.Area);
+
+      for (unsigned Pos = N.Pos; Pos < Order.size(); Pos++) {
+        if (N.Blocked.test(Pos))
+          continue;
+
+        const MCIRow &Row = MCI[Order[Pos]];
+        double Reduced_Merit = Row.Merit - Lambda * Row.Area;
+        if (Reduced_Merit <= 0)
+          continue;
+
+        if (Row.Indexes.empty()) {
+          Merit += Reduced_Merit;
+          continue;
+        }
+
+        double Share = Reduced_Merit / Row.Indexes.size();
+        for (unsigned j = 0; j < Row.Indexes.size(); j++)
+          Index_Merit[Row.Indexes[j]] = std::max(Index_Merit[Row.Indexes[j]], Share);
+      }
+
+      for (unsigned f = 0; f < Index_Merit.size(); f++)
+        Merit += Index_Merit[f];
+
+      return (long long) ceil(Merit) + 1;
+    }
+
+    // Whether Row fits in the Resource budgets left after Used.
+    //
+    bool fits(const long long *Used, const MCIRow &Row) {
+
+      for (unsigned r = 0; r < Resource_Budget.size(); r++)
+        if (Resource_Budget[r] > 0 && r < Row.Resources.size() && Used[r] + Row.Resources[r] > Resource_Budget[r])
+          return false;
+      return true;
+    }
+
+    // N with the candidate at Pos chosen - Blocked left to the caller.
+    //
+    Node include(const Node &N, unsigned Pos) {
+
+      const MCIRow &Row = MCI[Order[Pos]];
+      Node Include = {Pos + 1, N.Merit + Row.Merit, N.Area + Row.Area, BitVector(), N.Chosen, {0}};
+      Include.Chosen.push_back(Pos);
+      for (unsigned r = 0; r < NUM_RESOURCES; r++)
+        Include.Used[r] = N.Used[r] + (r < Row.Resources.size() ? Row.Resources[r] : 0);
+      return Include;
+    }
+
+    void updateBestMerit(long long Merit) {
+
+      long long Best = BestMerit.load();
+      while (Merit > Best && !BestMerit.compare_exchange_weak(Best, Merit))
+        ;
+    }
+
+    // Depth first search below N, include before exclude. Only subtrees that
+    // cannot reach the best Merit of all threads are pruned, so every thread
+    // keeps the first best selection of its own subtree.
+    //
+    void search(Node &N, Selection &Best, std::vector<BitVector> &Blocked_Stack, std::vector<double> &Index_Merit) {
+
+      if (N.Merit > Best.Merit) {
+        Best.Merit = N.Merit;
+        Best.Area = N.Area;
+        Best.Candidates = N.Chosen;
+        updateBestMerit(N.Merit);
+      }
+
+      if (Timed_Out.load() || (Time_Limit > 0 && std::chrono::steady_clock::now() > Deadline)) {
+        Timed_Out = true;
+        return;
+      }
+
+      while (N.Pos < Order.size() && N.Blocked.test(N.Pos))
+        N.Pos++;
+
+      if (N.Pos == Order.size())
+        return;
+
+      long long MaxMerit = N.Merit + Bound[N.Pos][(Budget - N.Area) / Granularity];
+      if (MaxMerit <= Best.Merit || MaxMerit < BestMerit.load())
+        return;
+
+      double Lambda;
+      MaxMerit = N.Merit + getFractionalBound(N, Lambda);
+      if (MaxMerit <= Best.Merit || MaxMerit < BestMerit.load())
+        return;
+
+      MaxMerit = N.Merit + getIndexBound(N, Lambda, Index_Merit);
+      if (MaxMerit <= Best.Merit || MaxMerit < BestMerit.load())
+        return;
+
+      if (Lambda > 0) {
+        MaxMerit = N.Merit + getIndexBound(N, 0, Index_Merit);
+        if (MaxMerit <= Best.Merit || MaxMerit < BestMerit.load())
+          return;
+      }
+
+      unsigned Pos = N.Pos;
+      const MCIRow &Row = MCI[Order[Pos]];
+
+      if (N.Area + Row.Area <= Budget && fits(N.Used, Row)) {
+        BitVector &Blocked = Blocked_Stack[N.Chosen.size()];
+        Blocked = N.Blocked;
+        Blocked |= Conflicts[Pos];
+
+        Node Include = include(N, Pos);
+        std::swap(Include.Blocked, Blocked);
+        search(Include, Best, Blocked_Stack, Index_Merit);
+        std::swap(Include.Blocked, Blocked);
+      }
+
+      N.Pos = Pos + 1;
+      search(N, Best, Blocked_Stack, Index_Merit);
+      N.Pos = Pos;
+    }
+
+    // The Skip knapsack DP with the Area in LUTs: one decision bit per
+    // candidate and LUT, and the rows of Merits only while a candidate
+    // still reads them. Its selection keeps the conflicts of every candidate
+    // with the ones right after it - if it keeps all of them and fits in the
+    // Resource budgets, no selection has more Merit.
+    //
+    bool solveNested(Selection &Result) {
+
+      if ((unsigned long long) Order.size() * (Budget + 1) > MAX_NESTED_DP_CELLS)
+        return false;
+
+      // Lowest position that reads each row.
+      std::vector<unsigned> First_Reader(Order.size() + 1);
+      for (unsigned j = 1; j <= Order.size(); j++)
+        First_Reader[j] = j - 1;
+      for (unsigned i = 0; i < Order.size(); i++)
+        First_Reader[Skip[i]] = std::min(First_Reader[Skip[i]], i);
+
+      std::vector<std::vector<long long> > Rows(Order.size() + 1);
+      std::vector<BitVector> Take(Order.size(), BitVector(Budget + 1));
+      Rows[Order.size()].assign(Budget + 1, 0);
+
+      for (int i = Order.size() - 1; i >= 0; i--) {
+        const MCIRow &Row = MCI[Order[i]];
+        const std::vector<long long> &After_Skip = Rows[Skip[i]];
+
+        Rows[i] = Rows[i + 1];
+        for (long long c = Row.Area; c <= Budget; c++)
+          if (Row.Merit + After_Skip[c - Row.Area] > Rows[i][c]) {
+            Rows[i][c] = Row.Merit + After_Skip[c - Row.Area];
+            Take[i].set(c);
+          }
+
+        if (First_Reader[i + 1] == (unsigned) i)
+          std::vector<long long>().swap(Rows[i + 1]);
+        if (First_Reader[Skip[i]] == (unsigned) i)
+          std::vector<long long>().swap(Rows[Skip[i]]);
+      }
+
+      Result = Selection{0, 0, std::vector<unsigned>()};
+      BitVector Blocked(Order.size());
+      long long Used[NUM_RESOURCES] = {0};
+
+      // From the least Area the best Merit takes.
+      long long Area_Left = Budget;
+      while (Area_Left > 0 && Rows[0][Area_Left - 1] == Rows[0][Budget])
+        Area_Left--;
+
+      for (unsigned i = 0; i < Order.size(); ) {
+        if (!Take[i].test(Area_Left)) {
+          i++;
+          continue;
+        }
+
+        const MCIRow &Row = MCI[Order[i]];
+        if (Blocked.test(i) || !fits(Used, Row))
+          return false;
+
+        for (unsigned r = 0; r < NUM_RESOURCES && r < Row.Resources.size(); r++)
+          Used[r] += Row.Resources[r];
+        Blocked |= Conflicts[i];
+        Result.Merit += Row.Merit;
+        Result.Area += Row.Area;
+        Result.Candidates.push_back(Order[i]);
+        Area_Left -= Row.Area;
+        i = Skip[i];
+      }
+      return true;
+    }
+
+    // Nodes after the first Depth decisions, in depth first order.
+    //
+    void split(Node N, unsigned Depth, std::vector<Node> &Nodes) {
+
+      while (N.Pos < Order.size() && N.Blocked.test(N.Pos))
+        N.Pos++;
+
+      if (Depth == 0 || N.Pos == Order.size()) {
+        Nodes.push_back(N);
+        return;
+      }
+
+      const MCIRow &Row = MCI[Order[N.Pos]];
+
+      if (N.Area + Row.Area <= Budget && fits(N.Used, Row)) {
+        Node Include = include(N, N.Pos);
+        Include.Blocked = N.Blocked;
+        Include.Blocked |= Conflicts[N.Pos];
+        split(Include, Depth - 1, Nodes);
+      }
+
+      N.Pos++;
+      split(N, Depth - 1, Nodes);
+    }
+
+    Selection solve(unsigned Depth) {
+
+      Selection Nested;
+      if (solveNested(Nested))
+        return Nested;
+
+      Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(Time_Limit);
+
+      std::vector<Node> Nodes;
+      Node Root = {0, 0, 0, BitVector(Order.size()), std::vector<unsigned>(), {0}};
+      split(Root, Depth, Nodes);
+
+      std::vector<Selection> Best(Nodes.size(), Selection{0, 0, std::vector<unsigned>()});
+      ThreadPool Pool;
+
+      for (unsigned i = 0; i < Nodes.size(); i++)
+        Pool.async([this, &Nodes, &Best, i]() {
+          std::vector<BitVector> Blocked_Stack(Order.size() + 1);
+          std::vector<double> Index_Merit(Num_Indexes);
+          search(Nodes[i], Best[i], Blocked_Stack, Index_Merit);
+        });
+      Pool.wait();
+
+      // First best selection in depth first order - the same on every run.
+      Selection Result = {0, 0, std::vector<unsigned>()};
+      for (unsigned i = 0; i < Best.size(); i++)
+        if (Best[i].Merit > Result.Merit)
+          Result = Best[i];
+
+      for (unsigned i = 0; i < Result.Candidates.size(); i++)
+        Result.Candidates[i] = Order[Result.Candidates[i]];
+
+      return Result;
+    }
+  };
+
+
+  // Merit vs Area Pareto frontier of the selections of MCI in one pass,
+  // under the Overlapping Rule.
+  //
+  // DP over the candidates: a label is a selection (Merit, Area) along with
+  // the Function Indexes it covers that later candidates still contain - the
+  // indexes no later candidate contains are dropped. Labels that cover the
+  // same indexes are compared on Merit and Area only, and the dominated ones
+  // are pruned.
+  //
+  struct ParetoFrontier {
+
+    struct Label {
+      long long Merit, Area;
+      unsigned Trace;                // Last choice, in Traces.
+    };
+
+    struct Trace {
+      unsigned Candidate;            // Row of MCI.
+      unsigned Parent;               // NO_TRACE for the first choice.
+    };
+
+    static const unsigned NO_TRACE = ~0U;
+
+    typedef std::map<std::vector<unsigned>, std::vector<Label> > LabelMap;
+
+    const std::vector<MCIRow> &MCI;
+    long long MaxArea;
+    std::vector<Trace> Traces;
+
+    ParetoFrontier(const std::vector<MCIRow> &MCI, long long MaxArea) : MCI(MCI), MaxArea(MaxArea) {}
+
+    // Keep the labels of increasing Area and strictly increasing Merit.
+    //
+    static void prune(std::vector<Label> &Labels) {
+
+      std::sort(Labels.begin(), Labels.end(), [](const Label &A, const Label &B) {
+        return A.Area < B.Area || (A.Area == B.Area && A.Merit > B.Merit);
+      });
+
+      unsigned Kept = 0;
+      for (unsigned i = 0; i < Labels.size(); i++)
+        if (Kept == 0 || Labels[i].Merit > Labels[Kept - 1].Merit)
+          Labels[Kept++] = Labels[i];
+      Labels.resize(Kept);
+    }
+
+    // A label is dominated as well by a label of no more Area and no less
+    // Merit that covers a subset of its indexes.
+    //
+    static void pruneBySubsets(LabelMap &Labels) {
+
+      for (LabelMap::iterator It = Labels.begin(); It != Labels.end(); ++It)
+        for (LabelMap::iterator Sub = Labels.begin(); Sub != Labels.end(); ++Sub) {
+
+          if (Sub == It || Sub->second.empty() || Sub->first.size() >= It->first.size()
+              || !std::includes(It->first.begin(), It->first.end(), Sub->first.begin(), Sub->first.end()))
+            continue;
+
+          // Both by increasing Area and Merit.
+          const std::vector<Label> &Dominant = Sub->second;
+          std::vector<Label> &Dominated = It->second;
+          unsigned Kept = 0, d = 0;
+
+          for (unsigned i = 0; i < Dominated.size(); i++) {
+            while (d + 1 < Dominant.size() && Dominant[d + 1].Area <= Dominated[i].Area)
+              d++;
+            if (Dominant[d].Area <= Dominated[i].Area && Dominant[d].Merit >= Dominated[i].Merit)
+              continue;
+            Dominated[Kept++] = Dominated[i];
+          }
+          Dominated.resize(Kept);
+        }
+    }
+
+    std::vector<Selection> solve() {
+
+      // Candidates by their lowest and highest index, so that the indexes of
+      // a call graph region are dropped soon after they are first covered.
+      std::vector<unsigned> Order;
+      unsigned Num_Indexes = 0;
+
+      for (unsigned i = 0; i < MCI.size(); i++)
+        if (MCI[i].Merit > 0 && MCI[i].Area <= MaxArea) {
+          Order.push_back(i);
+          for (unsigned j = 0; j < MCI[i].Indexes.size(); j++)
+            Num_Indexes = std::max(Num_Indexes, MCI[i].Indexes[j] + 1);
+        }
+
+      std::vector<std::vector<unsigned> > Indexes(MCI.size());
+      for (unsigned i = 0; i < Order.size(); i++) {
+        Indexes[Order[i]] = MCI[Order[i]].Indexes;
+        std::sort(Indexes[Order[i]].begin(), Indexes[Order[i]].end());
+        Indexes[Order[i]].erase(std::unique(Indexes[Order[i]].begin(), Indexes[Order[i]].end()),
+                                Indexes[Order[i]].end());
+      }
+
+      std::stable_sort(Order.begin(), Order.end(), [&Indexes](unsigned A, unsigned B) {
+        if (Indexes[A].empty() || Indexes[B].empty())
+          return Indexes[A].size() > Indexes[B].size();
+        return std::make_pair(Indexes[A].front(), Indexes[A].back())
+          < std::make_pair(Indexes[B].front(), Indexes[B].back());
+      });
+
+      std::vector<unsigned> Last_Pos(Num_Indexes, 0);
+      for (unsigned i = 0; i < Order.size(); i++)
+        for (unsigned j = 0; j < Indexes[Order[i]].size(); j++)
+          Last_Pos[Indexes[Order[i]][j]] = i;
+
+      LabelMap Labels;
+      Labels[std::vector<unsigned>()].push_back(Label{0, 0, NO_TRACE});
+
+      for (unsigned Pos = 0; Pos < Order.size(); Pos++) {
+
+        unsigned C = Order[Pos];
+        const std::vector<unsigned> &C_Indexes = Indexes[C];
+        LabelMap Next;
+
+        for (LabelMap::iterator It = Labels.begin(); It != Labels.end(); ++It) {
+
+          // Candidate left out.
+          std::vector<unsigned> Key;
+          for (unsigned i = 0; i < It->first.size(); i++)
+            if (Last_Pos[It->first[i]] > Pos)
+              Key.push_back(It->first[i]);
+
+          std::vector<Label> &Out = Next[Key];
+          Out.insert(Out.end(), It->second.begin(), It->second.end());
+
+          // Candidate chosen, if it covers none of the indexes of the label.
+          std::vector<unsigned> Union;
+          std::set_union(It->first.begin(), It->first.end(), C_Indexes.begin(), C_Indexes.end(),
+                         std::back_inserter(Union));
+          if (Union.size() != It->first.size() + C_Indexes.size())
+            continue;
+
+          Key.clear();
+          for (unsigned i = 0; i < Union.size(); i++)
+            if (Last_Pos[Union[i]] > Pos)
+              Key.push_back(Union[i]);
+
+          std::vector<Label> &Chosen = Next[Key];
+          for (unsigned i = 0; i < It->second.size(); i++) {
+            const Label &L = It->second[i];
+            if (L.Area + MCI[C].Area > MaxArea)
+              break; // Labels by increasing Area.
+            Traces.push_back(Trace{C, L.Trace});
+            Chosen.push_back(Label{L.Merit + MCI[C].Merit, L.Area + MCI[C].Area, (unsigned) Traces.size() - 1});
+          }
+        }
+
+        for (LabelMap::iterator It = Next.begin(); It != Next.end(); ++It)
+          prune(It->second);
+        pruneBySubsets(Next);
+
+        Labels.swap(Next);
+      }
+
+      // Every index is dropped after the last candidate: a single label set.
+      std::vector<Label> Frontier;
+      for (LabelMap::iterator It = Labels.begin(); It != Labels.end(); ++It)
+        Frontier.insert(Frontier.end(), It->second.begin(), It->second.end());
+      prune(Frontier);
+
+      std::vector<Selection> Result;
+      for (unsigned i = 0; i < Frontier.size(); i++) {
+        Selection S = {Frontier[i].Merit, Frontier[i].Area, std::vector<unsigned>()};
+        for (unsigned t = Frontier[i].Trace; t != NO_TRACE; t = Traces[t].Parent)
+          S.Candidates.push_back(Traces[t].Candidate);
+        std::reverse(S.Candidates.begin(), S.Candidates.end());
+        Result.push_back(S);
+      }
+      return Result;
+    }
+  };
+
+}
@@ -13,18 +13,21 @@ BENCH=$1	# Name of the Benchmark
 ALPHA=$2	# Parameter that affects the Bandwidth for IO latency
 OVHD=$3 	# Invocation Overhead
 
+# LLVM build directory - Edit this line. LLVM_BUILD=path/to/llvm/build
+export LLVM_BUILD=../..//hpvm/hpvm/build
+
 
 cp LA.txt LA.LLVM.txt
-$SCRIPTS_DIR/compute_merit.sh $BENCH $ALPHA $OVHD
+$LLVM_BUILD/bin/accelseeker-mc -mode=merit -bench=$BENCH -alpha=$ALPHA -overhead=$OVHD
 $SCRIPTS_DIR/remove_fractional_point.sh MC.txt
 $SCRIPTS_DIR/generate_accelcands_list.sh 
 $SCRIPTS_DIR/filter_mci.sh MCI.txt
 cp MCI.txt MCI.llvm.txt
 
 # Task Level Parallelism Estimation.
-$SCRIPTS_DIR/compute_sw_hw.sh $ALPHA $OVHD
+$LLVM_BUILD/bin/accelseeker-mc -mode=sw-hw -alpha=$ALPHA -overhead=$OVHD
 $SCRIPTS_DIR/remove_fractional_point.sh SW_HW_AREA.txt
-$SCRIPTS_DIR/extract_tlp.sh $BENCH
+$LLVM_BUILD/bin/accelseeker-mc -mode=tlp -bench=$BENCH
 $SCRIPTS_DIR/filter_mci.sh MCI_tlp_opt.txt 
 cp MCI.txt.orig MCI.tlp.txt
 $SCRIPTS_DIR/filter_mci.sh MCI.tlp.txt
@@ -34,7 +37,7 @@ cat MCI_tlp_opt.txt >> MCI.tlp.txt
 # Prepare IO FCI files for application of the parallelism models.
 $SCRIPTS_DIR/update_io.sh; $SCRIPTS_DIR/update_fci.sh 
 $SCRIPTS_DIR/extract_llp.sh 
-$SCRIPTS_DIR/compute_merit_llp.sh $BENCH $ALPHA $OVHD
+$LLVM_BUILD/bin/accelseeker-mc -mode=merit-llp -bench=$BENCH -alpha=$ALPHA -overhead=$OVHD
 $SCRIPTS_DIR/remove_fractional_point.sh MC_HPVM_LLP.txt
 cp MC_HPVM_LLP.txt MC.txt; cp FCI_HPVM_LLP.txt FCI.txt;
 $SCRIPTS_DIR/generate_accelcands_list.sh
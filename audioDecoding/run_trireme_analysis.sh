@@ -26,6 +26,9 @@ TOP_LEVEL=6
 # Directory that contains the IR .ll files. (if needed to be specified - default=empty)
 IRDIR= 
 
+# Indexed profile (.profdata) of the instrumented app, applied to $BENCH in memory. (default=empty - counts of the IR)
+PROFILE=
+
 # Stop Editing.
 
 if [ ! -f "$BENCH" ]; then
@@ -36,17 +39,14 @@ else
 fi
 
 # Collects IO information, Indexes info and generates .gv call graph files for every function.
-$LLVM_BUILD/bin/opt -load $LLVM_BUILD/lib/AccelSeekerIO.so -AccelSeekerIO -stats    > /dev/null  $BENCH
+$LLVM_BUILD/bin/opt -load $LLVM_BUILD/lib/AccelSeekerIO.so -AccelSeekerIO ${PROFILE:+-accelseeker-profile=$PROFILE} -stats    > /dev/null  $BENCH
 
-# Collects SW, HW and AREA estimation bottom up.
-for ((i=0; i <= $TOP_LEVEL ; i++)) ; do
-	echo "$i"
- printf "$i" > level.txt
+# Collects SW, HW and AREA estimation bottom up. All Levels up to TOP_LEVEL in a single run.
+printf "$TOP_LEVEL" > level.txt
 
-$LLVM_BUILD/bin/opt -load $LLVM_BUILD/lib/AccelSeeker.so -AccelSeeker -stats    > /dev/null  $BENCH
-done
+$LLVM_BUILD/bin/opt -load $LLVM_BUILD/lib/AccelSeeker.so -AccelSeeker ${PROFILE:+-accelseeker-profile=$PROFILE} -stats    > /dev/null  $BENCH
 
-cp LA_$TOP_LEVEL.txt LA.txt; mkdir analysis_data; mv SW_*.txt HW_*.txt AREA_*.txt LA_*.txt analysis_data/.  
+cp LA_$TOP_LEVEL.txt LA.txt; cp RES_$TOP_LEVEL.txt RES.txt; mkdir analysis_data; mv SW_*.txt HW_*.txt AREA_*.txt LA_*.txt RES_*.txt analysis_data/.  
 rm level.txt
 
 # Keep the top performing tasks from the entire analysis.
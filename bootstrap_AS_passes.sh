@@ -6,3 +6,6 @@ export LLVM_SRC_TREE="hpvm/hpvm/llvm/"
 cp -r AccelSeeker  AccelSeekerIO  $LLVM_SRC_TREE/lib/Transforms/.
 echo "add_subdirectory(AccelSeeker)" >> $LLVM_SRC_TREE/lib/Transforms/CMakeLists.txt 
 echo "add_subdirectory(AccelSeekerIO)" >> $LLVM_SRC_TREE/lib/Transforms/CMakeLists.txt 
+
+# Copy the Merit/Cost tool to the tools of the LLVM source tree (picked up as a tool subdirectory).
+cp -r AccelSeekerMC $LLVM_SRC_TREE/tools/.
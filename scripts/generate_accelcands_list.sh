@@ -8,7 +8,7 @@ printf "Compute Merit/Cost File - MC.txt"
 
 printf "Generate Overlapping Rule - FCI_CROPPED_OVERLAP_RULE.txt"
 $SCRIPTS_DIR/prune_fci_files.sh
-python $SCRIPTS_DIR/generate_overlapping_rule.py 
+$LLVM_BUILD/bin/accelseeker-mc -mode=overlap
 
 printf "Merge MC.txt and FCI_CROPPED_OVERLAP_RULE.txt"
 printf "Generate AccelSeeker Candidates list with Merit/Cost and Call Function Indexes - MCI.txt"
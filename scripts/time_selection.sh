@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# This script times the exact selection of accelseeker-mc on a generated
+# MCI file: one candidate per Function of a random call tree, its Function
+# Indexes the Functions of its subtree (as the FCI sets of a call tree).
+# It fails if a budget takes longer than MAX_SECS - the search stops at the
+# time limit then, with a selection not proven the best - or if the
+# selection of a known MCI file is not the best one.
+#
+# usage: time_selection.sh [ROWS] [BUDGETS] [MAX_SECS]
+# e.g.   time_selection.sh 600 5000,20000,100000 10
+
+ROWS=${1:-600}
+BUDGETS=${2:-5000,20000,100000}
+MAX_SECS=${3:-10}
+LLVM_BUILD=${LLVM_BUILD:-path/to/llvm/build}
+
+WORK_DIR=$(mktemp -d)
+cd $WORK_DIR
+
+# Parent of Function i is a random Function before it. Merit and Area random.
+awk -v n=$ROWS 'BEGIN {
+  srand(1);
+  for (i = 1; i < n; i++) parent[i] = int(rand() * i);
+  for (i = 0; i < n; i++) { merit[i] = 1000 + int(rand() * 999000); area[i] = 100 + int(rand() * 4900); set[i] = i; }
+  for (i = n - 1; i > 0; i--) set[parent[i]] = set[parent[i]] "," set[i];
+  for (i = 0; i < n; i++) print "bench @f" i " " merit[i] " " area[i] " " set[i];
+}' > MCI.txt
+
+STATUS=0
+
+# Rows that repeat a Function Index (7,7 and 8,3,8, as the IND1,IND2 of TLP
+# rows may) - the best selection at 8000 LUTs is @f1 @f3 @f4 @f5, Merit 285268.
+printf "%s\n" "bench @f0 19641 959 2,5,9" "bench @f1 97057 72 10,9" "bench @f2 39387 137 9" \
+  "bench @f3 93502 1758 7,7" "bench @f4 12673 156 8,3,8" "bench @f5 82036 1243 11" \
+  "bench @f6 69905 2406 8,11" "bench @f7 36558 2491 6,10" > KNOWN.txt
+$LLVM_BUILD/bin/accelseeker-mc -mode=select -mci=KNOWN.txt -budget=8000 2> log.txt
+MERIT=$(awk '{ print $3 }' SELECTION.txt)
+if [ "$MERIT" != "285268" ]; then
+  echo "Known MCI file: Merit $MERIT, best 285268."
+  STATUS=1
+fi
+
+for BUDGET in ${BUDGETS//,/ }; do
+  START=$(date +%s.%N)
+  $LLVM_BUILD/bin/accelseeker-mc -mode=select -mci=MCI.txt -budget=$BUDGET -time-limit=$MAX_SECS 2> log.txt
+  SECS=$(awk -v Start=$START -v End=$(date +%s.%N) 'BEGIN { printf "%.2f", End - Start }')
+  echo "$ROWS rows, budget $BUDGET: $SECS s"
+  if grep -q warning_time_limit log.txt; then
+    echo "Time limit of $MAX_SECS s reached."
+    STATUS=1
+  fi
+done
+
+cd - > /dev/null
+rm -rf $WORK_DIR
+exit $STATUS